@@ -9,6 +9,13 @@ WifiTest_OBJECTS := \
   $(OBJDIR)/WifiStatusJson_715858f8.o \
   $(OBJDIR)/WifiStatus_30949170.o \
   $(OBJDIR)/Utils_e4b11b92.o \
+  $(OBJDIR)/AsyncInit_866e8fed.o \
+  $(OBJDIR)/ImageKernels_cf684fa1.o \
+  $(OBJDIR)/ImageScaling_95ea104b.o \
+  $(OBJDIR)/AssetResolver_74d6f41f.o \
+  $(OBJDIR)/DirectoryWatcher_98aacfa2.o \
+  $(OBJDIR)/DiskImageCache_f9261709.o \
+  $(OBJDIR)/SharedImageCache_59b20d82.o \
   $(OBJDIR)/juce_core_e13be5a9.o \
   $(OBJDIR)/juce_data_structures_b87144a5.o \
   $(OBJDIR)/juce_events_8da1559d.o \
@@ -32,3 +39,106 @@ $(OBJDIR)/WifiTest_1459807182.o: ../../Source/WifiTest.cpp
 	-@mkdir -p $(OBJDIR)
 	@echo "Compiling WifiTest.cpp"
 	@$(CXX) $(CXXFLAGS) -o "$@" -c "$<"
+
+# SharedImageCache releasing images, links JUCE and the image loading code only.
+ImageCacheTest_OBJECTS := \
+  $(JUCE_OBJDIR)/SharedImageCache_59b20d82.o \
+  $(JUCE_OBJDIR)/DiskImageCache_f9261709.o \
+  $(JUCE_OBJDIR)/ImageScaling_95ea104b.o \
+  $(JUCE_OBJDIR)/ImageKernels_cf684fa1.o \
+  $(JUCE_OBJDIR)/juce_core_75b14332.o \
+  $(JUCE_OBJDIR)/juce_data_structures_72d3da2c.o \
+  $(JUCE_OBJDIR)/juce_events_d2be882c.o \
+  $(JUCE_OBJDIR)/juce_graphics_9c18891e.o \
+  $(JUCE_OBJDIR)/juce_gui_basics_8a6da59c.o \
+  $(JUCE_OBJDIR)/ImageCacheTest_3ed6291a.o \
+
+$(JUCE_OUTDIR)/imagecachetest: $(ImageCacheTest_OBJECTS)
+	@echo Linking imagecachetest
+	-@mkdir -p $(JUCE_OUTDIR)
+	@$(CXX) -o $@ $(ImageCacheTest_OBJECTS) $(JUCE_LDFLAGS)
+
+$(JUCE_OBJDIR)/ImageCacheTest_3ed6291a.o: ../../Source/ImageCacheTest.cpp
+	-@mkdir -p $(JUCE_OBJDIR)
+	@echo "Compiling ImageCacheTest.cpp"
+	@$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+# The config.json parser and model, links JUCE but none of the launcher UI.
+AppConfigTest_OBJECTS := \
+  $(JUCE_OBJDIR)/AppConfigModel_3b8bdeb2.o \
+  $(JUCE_OBJDIR)/ConfigWriter_a5fce686.o \
+  $(JUCE_OBJDIR)/DirectoryWatcher_98aacfa2.o \
+  $(JUCE_OBJDIR)/juce_core_75b14332.o \
+  $(JUCE_OBJDIR)/juce_data_structures_72d3da2c.o \
+  $(JUCE_OBJDIR)/juce_events_d2be882c.o \
+  $(JUCE_OBJDIR)/juce_graphics_9c18891e.o \
+  $(JUCE_OBJDIR)/juce_gui_basics_8a6da59c.o \
+  $(JUCE_OBJDIR)/AppConfigTest_55d5b2c3.o \
+
+$(JUCE_OUTDIR)/appconfigtest: $(AppConfigTest_OBJECTS)
+	@echo Linking appconfigtest
+	-@mkdir -p $(JUCE_OUTDIR)
+	@$(CXX) -o $@ $(AppConfigTest_OBJECTS) $(JUCE_LDFLAGS)
+
+$(JUCE_OBJDIR)/AppConfigTest_55d5b2c3.o: ../../Source/AppConfigTest.cpp
+	-@mkdir -p $(JUCE_OBJDIR)
+	@echo "Compiling AppConfigTest.cpp"
+	@$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+# The image kernels don't use JUCE, so their test and benchmark link only the kernels.
+KernelTest_OBJECTS := \
+  $(JUCE_OBJDIR)/ImageKernels_cf684fa1.o \
+  $(JUCE_OBJDIR)/ImageKernelsTest_0b3f5d21.o \
+
+KernelBench_OBJECTS := \
+  $(JUCE_OBJDIR)/ImageKernels_cf684fa1.o \
+  $(JUCE_OBJDIR)/ImageKernelsBench_6c2a90e4.o \
+
+# Grid and config scaling with large app libraries, links JUCE but none of the launcher UI.
+LibraryBench_OBJECTS := \
+  $(JUCE_OBJDIR)/AppConfigModel_3b8bdeb2.o \
+  $(JUCE_OBJDIR)/ConfigWriter_a5fce686.o \
+  $(JUCE_OBJDIR)/DirectoryWatcher_98aacfa2.o \
+  $(JUCE_OBJDIR)/Grid_a461bccf.o \
+  $(JUCE_OBJDIR)/Utils_e4b11b92.o \
+  $(JUCE_OBJDIR)/AssetResolver_74d6f41f.o \
+  $(JUCE_OBJDIR)/SharedImageCache_59b20d82.o \
+  $(JUCE_OBJDIR)/DiskImageCache_f9261709.o \
+  $(JUCE_OBJDIR)/ImageScaling_95ea104b.o \
+  $(JUCE_OBJDIR)/ImageKernels_cf684fa1.o \
+  $(JUCE_OBJDIR)/juce_core_75b14332.o \
+  $(JUCE_OBJDIR)/juce_data_structures_72d3da2c.o \
+  $(JUCE_OBJDIR)/juce_events_d2be882c.o \
+  $(JUCE_OBJDIR)/juce_graphics_9c18891e.o \
+  $(JUCE_OBJDIR)/juce_gui_basics_8a6da59c.o \
+  $(JUCE_OBJDIR)/LibraryBench_bddad4e1.o \
+
+$(JUCE_OUTDIR)/kerneltest: $(KernelTest_OBJECTS)
+	@echo Linking kerneltest
+	-@mkdir -p $(JUCE_OUTDIR)
+	@$(CXX) -o $@ $(KernelTest_OBJECTS) $(TARGET_ARCH)
+
+$(JUCE_OUTDIR)/kernelbench: $(KernelBench_OBJECTS)
+	@echo Linking kernelbench
+	-@mkdir -p $(JUCE_OUTDIR)
+	@$(CXX) -o $@ $(KernelBench_OBJECTS) $(TARGET_ARCH)
+
+$(JUCE_OUTDIR)/librarybench: $(LibraryBench_OBJECTS)
+	@echo Linking librarybench
+	-@mkdir -p $(JUCE_OUTDIR)
+	@$(CXX) -o $@ $(LibraryBench_OBJECTS) $(JUCE_LDFLAGS)
+
+$(JUCE_OBJDIR)/ImageKernelsTest_0b3f5d21.o: ../../Source/ImageKernelsTest.cpp
+	-@mkdir -p $(JUCE_OBJDIR)
+	@echo "Compiling ImageKernelsTest.cpp"
+	@$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+$(JUCE_OBJDIR)/ImageKernelsBench_6c2a90e4.o: ../../Source/ImageKernelsBench.cpp
+	-@mkdir -p $(JUCE_OBJDIR)
+	@echo "Compiling ImageKernelsBench.cpp"
+	@$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+$(JUCE_OBJDIR)/LibraryBench_bddad4e1.o: ../../Source/LibraryBench.cpp
+	-@mkdir -p $(JUCE_OBJDIR)
+	@echo "Compiling LibraryBench.cpp"
+	@$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
@@ -1,4 +1,5 @@
 #include "AdvancedSettingsPage.h"
+#include "StartupProfiler.h"
 
 AdvancedSettingsPage::AdvancedSettingsPage(LauncherComponent* lc):
 bg_color(0xffd23c6d),
@@ -8,10 +9,10 @@ removeLogin("Remove your password"),
 personalizeButton("Personalize your homepage"),
 dateandtime("Date and time"),
 inputoptions("Input settings"),
-spl(new SettingsPageLogin),
-datetime(new DateTimePage(lc)),
-ppc(new PersonalizePageComponent(lc)),
-inputsettings(new InputSettingsPage(lc)),
+spl(createTimed<SettingsPageLogin>("login settings page")),
+datetime(createTimed<DateTimePage>("date and time page", lc)),
+ppc(createTimed<PersonalizePageComponent>("personalize page", lc)),
+inputsettings(createTimed<InputSettingsPage>("input settings page", lc)),
 index(0)
 {
   //Title font
@@ -99,10 +100,6 @@ void AdvancedSettingsPage::resized(){
   checkNav();
 }
 
-void AdvancedSettingsPage::deleteIcon(String name, String shell){
-  ppc->deleteIcon(name, shell);
-}
-
 void AdvancedSettingsPage::displayNoPassword(){
 AlertWindow::showMessageBoxAsync(AlertWindow::AlertIconType::WarningIcon,
                                   "Error", 
@@ -19,7 +19,6 @@ public:
   void buttonClicked(Button*) override;
   void paint(Graphics&) override;
   void resized() override;
-  void deleteIcon(String, String);
   void displayNoPassword();
 
 private:
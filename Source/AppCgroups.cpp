@@ -0,0 +1,206 @@
+#include "AppCgroups.h"
+#include "AppConfigModel.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char *launcherCgroupName = "launcher";
+// apps default to 100, the launcher wins when it has anything to do
+const int launcherCpuWeight = 500;
+// kept out of reclaim while apps have anything left to give back
+const int64 launcherMemoryLow = 32 * 1024 * 1024;
+
+// cgroupfs files take a single write(), File::replaceWithText() would rename a temp file over them
+bool writeControl(const File &cgroup, const char *name, const String &value) {
+  const auto path = cgroup.getChildFile(name).getFullPathName();
+  const int fd = ::open(path.toRawUTF8(), O_WRONLY | O_CLOEXEC);
+  const auto text = value.toRawUTF8();
+  const size_t size = strlen(text);
+  const bool ok = fd >= 0 && write(fd, text, size) == (ssize_t)size;
+  if (fd >= 0) close(fd);
+  if (!ok) DBG("AppCgroups: couldn't write " << value << " to " << path);
+  return ok;
+}
+
+String readControl(const File &cgroup, const char *name) {
+  return cgroup.getChildFile(name).loadFileAsString().trim();
+}
+
+// "96M" and the like into bytes, -1 for no limit
+int64 parseMemory(const var &value) {
+  if (value.isInt() || value.isInt64() || value.isDouble()) return jmax((int64)0, (int64)value);
+  const auto text = value.toString().trim().toUpperCase();
+  const auto digits = text.initialSectionContainingOnly("0123456789");
+  if (digits.isEmpty()) return -1;
+  const auto suffix = text.substring(digits.length()).trim().trimCharactersAtEnd("B");
+  const int64 scale = suffix.isEmpty() ? 1
+                    : suffix == "K" ? (int64)1 << 10
+                    : suffix == "M" ? (int64)1 << 20
+                    : suffix == "G" ? (int64)1 << 30 : 0;
+  if (!scale) {
+    DBG("AppCgroups: ignoring memory limit " << text);
+    return -1;
+  }
+  return digits.getLargeIntValue() * scale;
+}
+
+File findOwnCgroup() {
+  StringArray lines;
+  File("/proc/self/cgroup").readLines(lines);
+  for (const auto &line : lines) {
+    // the v2 hierarchy, "0::/user.slice/..."
+    if (line.startsWith("0::"))
+      return File("/sys/fs/cgroup").getChildFile(line.substring(4).trim());
+  }
+  return File::nonexistent;
+}
+
+}
+
+AppCgroups::Limits AppCgroups::Limits::forApp(const AppItem &app) {
+  Limits limits;
+  limits.memoryHigh = parseMemory(app.extraProperties["memoryHigh"]);
+  limits.memoryMax = parseMemory(app.extraProperties["memoryMax"]);
+  const int weight = app.extraProperties["cpuWeight"];
+  limits.cpuWeight = weight >= 1 && weight <= 10000 ? weight : 0;
+  return limits;
+}
+
+AppCgroups &AppCgroups::getInstance() {
+  static AppCgroups instance;
+  return instance;
+}
+
+AppCgroups::AppCgroups() {
+  ProcessSupervisor::getInstance().addListener(this);
+}
+
+AppCgroups::~AppCgroups() {
+  ProcessSupervisor::getInstance().removeListener(this);
+}
+
+AppCgroups::Mode AppCgroups::init() {
+  const auto found = initDelegated() ? Mode::delegated : probeSystemd() ? Mode::systemd : Mode::none;
+  DBG("AppCgroups: placing apps "
+      << (found == Mode::delegated ? "in " + root.getFullPathName()
+          : found == Mode::systemd ? String("with systemd-run") : String("nowhere")));
+  const ScopedLock sl(lock);
+  mode = found;
+  return found;
+}
+
+AppCgroups::Mode AppCgroups::getMode() const {
+  const ScopedLock sl(lock);
+  return mode;
+}
+
+bool AppCgroups::initDelegated() {
+  const auto own = findOwnCgroup();
+  if (!own.isDirectory()) return false;
+  // restarted by something that kept us in the leaf made last time
+  const auto base = own.getFileName() == launcherCgroupName ? own.getParentDirectory() : own;
+
+  StringArray controllers;
+  controllers.addTokens(readControl(base, "cgroup.controllers"), false);
+  if (!controllers.contains("memory") || !controllers.contains("cpu")) return false;
+  if (!base.getChildFile("cgroup.subtree_control").hasWriteAccess()) return false;
+
+  // controllers only pass down from a cgroup with no processes of its own, so the launcher
+  // moves into a leaf first
+  const auto launcher = base.getChildFile(launcherCgroupName);
+  if (!launcher.isDirectory() && launcher.createDirectory().failed()) return false;
+  if (!writeControl(launcher, "cgroup.procs", String(getpid()))) return false;
+  if (!writeControl(base, "cgroup.subtree_control", "+memory +cpu")) {
+    // something else shares the cgroup with us, it isn't ours to split up
+    writeControl(base, "cgroup.procs", String(getpid()));
+    launcher.deleteFile();
+    return false;
+  }
+  writeControl(launcher, "cpu.weight", String(launcherCpuWeight));
+  writeControl(launcher, "memory.low", String(launcherMemoryLow));
+
+  const ScopedLock sl(lock);
+  root = base;
+  removeUnused();
+  return true;
+}
+
+bool AppCgroups::probeSystemd() {
+  // also tells apart a systemd too old for these properties, which would refuse to run apps
+  StringArray args{ "systemd-run", "--user", "--scope", "--quiet",
+                    "--property=MemoryHigh=infinity", "--property=MemoryMax=infinity",
+                    "--property=CPUWeight=100", "true" };
+  ChildProcess probe;
+  if (!probe.start(args, 0)) return false;
+  if (!probe.waitForProcessToFinish(5000)) {
+    probe.kill();
+    return false;
+  }
+  return probe.getExitCode() == 0;
+}
+
+int AppCgroups::launch(const String &command, const String &name, const Limits &limits) {
+  auto &supervisor = ProcessSupervisor::getInstance();
+  auto args = ProcessSupervisor::splitCommand(command);
+  if (args.isEmpty()) return -1;
+
+  const ScopedLock sl(lock);
+  if (mode == Mode::systemd) {
+    // --scope runs the app in systemd-run's own process, the pid stays the app's
+    StringArray run{ "systemd-run", "--user", "--scope", "--quiet" };
+    if (limits.memoryHigh >= 0) run.add("--property=MemoryHigh=" + String(limits.memoryHigh));
+    if (limits.memoryMax >= 0) run.add("--property=MemoryMax=" + String(limits.memoryMax));
+    if (limits.cpuWeight > 0) run.add("--property=CPUWeight=" + String(limits.cpuWeight));
+    run.add("--");
+    run.addArray(args);
+    return supervisor.launch(run);
+  }
+
+  if (mode == Mode::delegated) {
+    const auto cgroup = createAppCgroup(name, limits);
+    const int pid = supervisor.launch(args, cgroup);
+    if (pid > 0 && cgroup != File::nonexistent) cgroupsByPid.set(pid, cgroup.getFullPathName());
+    else if (cgroup != File::nonexistent) cgroup.deleteFile();
+    return pid;
+  }
+
+  return supervisor.launch(args);
+}
+
+File AppCgroups::createAppCgroup(const String &name, const Limits &limits) {
+  auto slug = name.toLowerCase().retainCharacters("abcdefghijklmnopqrstuvwxyz0123456789-_");
+  if (slug.isEmpty()) slug = "app";
+  const auto cgroup = root.getNonexistentChildFile("app-" + slug, "", false);
+  if (cgroup.createDirectory().failed()) return File::nonexistent;
+
+  if (limits.memoryHigh >= 0) writeControl(cgroup, "memory.high", String(limits.memoryHigh));
+  if (limits.memoryMax >= 0) writeControl(cgroup, "memory.max", String(limits.memoryMax));
+  if (limits.cpuWeight > 0) writeControl(cgroup, "cpu.weight", String(limits.cpuWeight));
+  // out of memory, the app goes as a whole rather than one of its helpers
+  writeControl(cgroup, "memory.oom.group", "1");
+  return cgroup;
+}
+
+// Removes app cgroups that nothing runs in any more, like ones whose app left a child
+// behind that has since exited, or ones from an earlier run. Populated ones stay.
+void AppCgroups::removeUnused() {
+  Array<File> cgroups;
+  root.findChildFiles(cgroups, File::findDirectories, false, "app-*");
+  for (const auto &cgroup : cgroups) {
+    if (!cgroupsByPid.containsValue(cgroup.getFullPathName())) cgroup.deleteFile();
+  }
+}
+
+void AppCgroups::processExited(const ProcessSupervisor::ExitInfo &info) {
+  const ScopedLock sl(lock);
+  if (!cgroupsByPid.contains(info.pid)) return;
+  const File cgroup(cgroupsByPid[info.pid]);
+  cgroupsByPid.remove(info.pid);
+
+  DBG("AppCgroups: " << cgroup.getFileName() << " peaked at "
+      << readControl(cgroup, "memory.peak") << " bytes, "
+      << readControl(cgroup, "cpu.stat").upToFirstOccurrenceOf("\n", false, false));
+  removeUnused();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ProcessSupervisor.h"
+
+struct AppItem;
+
+// Starts every app in a cgroup (v2) of its own, so a heavy app is throttled and, when it
+// runs out of memory, OOM-killed on its own instead of taking the launcher or X with it.
+// The kernel keeps per-app memory and CPU accounting for each of them as well.
+//
+// If the launcher's own cgroup is delegated to it (writable, with the memory and cpu
+// controllers), it moves itself into a "launcher" leaf there with a heavier cpu.weight and
+// makes a sibling "app-<name>" cgroup per launch. Otherwise, apps are wrapped in
+// `systemd-run --user --scope` when the user's systemd takes those properties. Failing
+// both, apps are started as before.
+class AppCgroups : private ProcessSupervisor::Listener {
+public:
+  // Per app limits, from optional properties of its config.json entry:
+  //   "memoryHigh": "96M", "memoryMax": "128M", "cpuWeight": 50
+  // Memory is in bytes, or with a K, M or G suffix. Past memoryHigh the app is slowed down
+  // and reclaimed from, past memoryMax it's OOM-killed. cpuWeight is 1 to 10000, against
+  // the default of 100.
+  struct Limits {
+    // -1 for no limit
+    int64 memoryHigh = -1;
+    int64 memoryMax = -1;
+    // 0 for the default
+    int cpuWeight = 0;
+
+    static Limits forApp(const AppItem &app);
+  };
+
+  enum class Mode { none, delegated, systemd };
+
+  static AppCgroups &getInstance();
+
+  // Works out which way apps can be placed and sets up for it. Blocking (it may probe
+  // systemd-run), run it off the message thread. Apps launched before it's done aren't
+  // placed anywhere.
+  Mode init();
+  Mode getMode() const;
+
+  // Message thread only. Like ProcessSupervisor::launch(command), in a cgroup named after
+  // the app when possible. Returns the pid, or -1.
+  int launch(const String &command, const String &name, const Limits &limits);
+
+private:
+  AppCgroups();
+  ~AppCgroups();
+
+  bool initDelegated();
+  static bool probeSystemd();
+  File createAppCgroup(const String &name, const Limits &limits);
+  void removeUnused();
+  void processExited(const ProcessSupervisor::ExitInfo &info) override;
+
+  CriticalSection lock;
+  Mode mode = Mode::none;
+  // delegated: the directory holding the launcher's leaf and the apps' cgroups
+  File root;
+  // delegated: the cgroup of each app still running
+  HashMap<int, String> cgroupsByPid;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AppCgroups)
+};
@@ -0,0 +1,716 @@
+#include "AppConfigModel.h"
+#include "DirectoryWatcher.h"
+
+// Single pass JSON reader that fills the AppConfig as it goes. Apps page items are read
+// straight into AppItems; every other value becomes a var, as JSON::parse would make it.
+// Like JUCE's parser it tolerates trailing commas, which the stock config.json has.
+class AppConfig::Parser {
+public:
+  Parser(AppConfig &config, const char *text, size_t size)
+  : config(config), start(text), p(text), end(text + size) {
+    // UTF-8 byte order mark
+    if (size >= 3 && memcmp(text, "\xef\xbb\xbf", 3) == 0) p += 3;
+  }
+
+  Result parseDocument() {
+    skipWhitespace();
+    DynamicObject::Ptr root = new DynamicObject();
+    const bool ok = parseObject([&](const String &key) -> bool {
+      var value;
+      if (key == "pages" && peek() == '[') {
+        if (!parsePages(value)) return false;
+      } else if (!parseValue(value)) {
+        return false;
+      }
+      root->setProperty(key, value);
+      return true;
+    });
+    if (!ok) return error;
+
+    skipWhitespace();
+    if (p != end) return fail("unexpected text after the closing '}'");
+    config.root = root.get();
+    return Result::ok();
+  }
+
+private:
+  char peek() const {
+    return p < end ? *p : 0;
+  }
+
+  bool consume(char c) {
+    if (peek() != c) return false;
+    ++p;
+    return true;
+  }
+
+  void skipWhitespace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+  }
+
+  bool fail(const String &message) {
+    int line = 1;
+    for (auto c = start; c < p; ++c) {
+      if (*c == '\n') ++line;
+    }
+    error = Result::fail("config.json line " + String(line) + ": " + message);
+    return false;
+  }
+
+  template <typename MemberParser> bool parseObject(MemberParser parseMember) {
+    if (!consume('{')) return fail("expected '{'");
+    for (;;) {
+      skipWhitespace();
+      if (consume('}')) return true;
+      String key;
+      if (!parseString(key)) return false;
+      skipWhitespace();
+      if (!consume(':')) return fail("expected ':' after \"" + key + "\"");
+      skipWhitespace();
+      if (!parseMember(key)) return false;
+      skipWhitespace();
+      if (consume(',')) continue;
+      if (consume('}')) return true;
+      return fail("expected ',' or '}'");
+    }
+  }
+
+  template <typename ElementParser> bool parseArray(ElementParser parseElement) {
+    if (!consume('[')) return fail("expected '['");
+    for (;;) {
+      skipWhitespace();
+      if (consume(']')) return true;
+      if (!parseElement()) return false;
+      skipWhitespace();
+      if (consume(',')) continue;
+      if (consume(']')) return true;
+      return fail("expected ',' or ']'");
+    }
+  }
+
+  bool parseValue(var &out) {
+    switch (peek()) {
+      case '{': {
+        DynamicObject::Ptr object = new DynamicObject();
+        if (!parseObject([&](const String &key) -> bool {
+              var value;
+              if (!parseValue(value)) return false;
+              object->setProperty(key, value);
+              return true;
+            }))
+          return false;
+        out = object.get();
+        return true;
+      }
+      case '[': {
+        Array<var> values;
+        if (!parseArray([&]() -> bool {
+              var value;
+              if (!parseValue(value)) return false;
+              values.add(value);
+              return true;
+            }))
+          return false;
+        out = values;
+        return true;
+      }
+      case '"': {
+        String text;
+        if (!parseString(text)) return false;
+        out = text;
+        return true;
+      }
+      case 't': return parseLiteral("true", true, out);
+      case 'f': return parseLiteral("false", false, out);
+      case 'n': return parseLiteral("null", var(), out);
+      default: return parseNumber(out);
+    }
+  }
+
+  bool parseLiteral(const char *literal, const var &value, var &out) {
+    const size_t length = strlen(literal);
+    if ((size_t)(end - p) < length || memcmp(p, literal, length) != 0)
+      return fail("unexpected character");
+    p += length;
+    out = value;
+    return true;
+  }
+
+  bool parseNumber(var &out) {
+    auto numberStart = p;
+    bool isInteger = true;
+    if (peek() == '-') ++p;
+    while (p < end) {
+      const char c = *p;
+      if (c >= '0' && c <= '9') {
+        ++p;
+      } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+        isInteger = false;
+        ++p;
+      } else {
+        break;
+      }
+    }
+    if (p == numberStart || (p - numberStart == 1 && *numberStart == '-'))
+      return fail("unexpected character");
+
+    const String number(numberStart, (size_t)(p - numberStart));
+    if (isInteger) {
+      const int64 value = number.getLargeIntValue();
+      out = (value == (int)value) ? var((int)value) : var(value);
+    } else {
+      out = number.getDoubleValue();
+    }
+    return true;
+  }
+
+  static void appendUTF8(std::string &text, uint32 c) {
+    if (c < 0x80) {
+      text += (char)c;
+    } else if (c < 0x800) {
+      text += (char)(0xc0 | (c >> 6));
+      text += (char)(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) {
+      text += (char)(0xe0 | (c >> 12));
+      text += (char)(0x80 | ((c >> 6) & 0x3f));
+      text += (char)(0x80 | (c & 0x3f));
+    } else {
+      text += (char)(0xf0 | (c >> 18));
+      text += (char)(0x80 | ((c >> 12) & 0x3f));
+      text += (char)(0x80 | ((c >> 6) & 0x3f));
+      text += (char)(0x80 | (c & 0x3f));
+    }
+  }
+
+  // U+FFFD, stands in for surrogates that aren't part of a pair, which UTF-8 can't encode
+  static const uint32 replacementCharacter = 0xfffd;
+
+  bool parseHex4(uint32 &value) {
+    if (end - p < 4) return fail("truncated \\u escape");
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      const int digit = CharacterFunctions::getHexDigitValue((juce_wchar)(uint8)*p++);
+      if (digit < 0) return fail("bad \\u escape");
+      value = (value << 4) | (uint32)digit;
+    }
+    return true;
+  }
+
+  bool parseString(String &out) {
+    if (!consume('"')) return fail("expected a string");
+    std::string text;
+    for (;;) {
+      if (p >= end) return fail("unterminated string");
+      const char c = *p++;
+      if (c == '"') break;
+      if (c != '\\') {
+        text += c;
+        continue;
+      }
+      if (p >= end) return fail("unterminated string");
+      const char escaped = *p++;
+      switch (escaped) {
+        case 'b': text += '\b'; break;
+        case 'f': text += '\f'; break;
+        case 'n': text += '\n'; break;
+        case 'r': text += '\r'; break;
+        case 't': text += '\t'; break;
+        case 'u': {
+          uint32 c1;
+          if (!parseHex4(c1)) return false;
+          if (c1 >= 0xd800 && c1 < 0xdc00) {
+            // a surrogate pair spells out one character beyond the BMP
+            const char *next = p;
+            uint32 c2 = 0;
+            if (end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+              p += 2;
+              if (!parseHex4(c2)) return false;
+            }
+            if (c2 >= 0xdc00 && c2 < 0xe000) {
+              c1 = 0x10000 + ((c1 - 0xd800) << 10) + (c2 - 0xdc00);
+            } else {
+              // a lone high surrogate, whatever follows it is read on its own
+              p = next;
+              c1 = replacementCharacter;
+            }
+          } else if (c1 >= 0xdc00 && c1 < 0xe000) {
+            c1 = replacementCharacter;
+          }
+          appendUTF8(text, c1);
+          break;
+        }
+        default: text += escaped; break; // \" \\ \/
+      }
+    }
+    out = String::fromUTF8(text.data(), (int)text.size());
+    return true;
+  }
+
+  bool parsePages(var &out) {
+    Array<var> pages;
+    if (!parseArray([&]() -> bool {
+          var page;
+          if (peek() == '{') {
+            if (!parsePage(page, pages.size())) return false;
+          } else if (!parseValue(page)) {
+            return false;
+          }
+          pages.add(page);
+          return true;
+        }))
+      return false;
+    out = pages;
+    return true;
+  }
+
+  bool parsePage(var &out, int pageIndex) {
+    DynamicObject::Ptr page = new DynamicObject();
+    OwnedArray<AppItem> items;
+    bool hasItems = false;
+    if (!parseObject([&](const String &key) -> bool {
+          if (key == "items" && peek() == '[') {
+            hasItems = true;
+            // placeholder, keeps the key where it was for when the config is written out
+            page->setProperty(key, var());
+            return parseArray([&]() -> bool { return parseItem(items); });
+          }
+          var value;
+          if (!parseValue(value)) return false;
+          page->setProperty(key, value);
+          return true;
+        }))
+      return false;
+
+    if (hasItems) {
+      if (config.appsPageIndex < 0 && page->getProperty("name").toString() == "Apps") {
+        config.appsPageIndex = pageIndex;
+        for (auto item : items) config.adoptApp(item);
+        items.clear(false);
+      } else {
+        Array<var> values;
+        for (auto item : items) values.add(appToJson(*item));
+        page->setProperty("items", values);
+      }
+    }
+    out = page.get();
+    return true;
+  }
+
+  bool parseItem(OwnedArray<AppItem> &items) {
+    if (peek() != '{') {
+      // not an app entry, there's nothing to show for it
+      var ignored;
+      return parseValue(ignored);
+    }
+
+    ScopedPointer<AppItem> item = new AppItem();
+    int typedFields = 0;
+    if (!parseObject([&](const String &key) -> bool {
+          var value;
+          if (!parseValue(value)) return false;
+          String *field = key == "name" ? &item->name
+                        : key == "icon" ? &item->icon
+                        : key == "shell" ? &item->shell : nullptr;
+          if (field && value.isString()) {
+            *field = value.toString();
+            ++typedFields;
+          } else {
+            item->extraProperties.set(key, value);
+          }
+          return true;
+        }))
+      return false;
+
+    item->complete = typedFields == 3;
+    items.add(item.release());
+    return true;
+  }
+
+  AppConfig &config;
+  const char *start, *p, *end;
+  Result error = Result::ok();
+};
+
+// Watches the config's directory rather than the file, saves replace it with a rename.
+// Bursts of events are collapsed into one reload on the message thread.
+// No reload happens while a menu, alert or edit window is up: the launcher's handlers hold
+// icon buttons across those modal loops, and a reload may delete them. It's retried once
+// the last one has closed.
+class AppConfig::Watcher : public DirectoryWatcher, private AsyncUpdater, private Timer {
+public:
+  Watcher(AppConfig &config, const File &file)
+  : DirectoryWatcher("AppConfig"), config(config), file(file) {
+    setDirectories({ file.getParentDirectory() });
+    startWatching();
+  }
+
+  ~Watcher() {
+    stopWatching();
+    cancelPendingUpdate();
+    stopTimer();
+  }
+
+private:
+  void filesChanged(const Array<File> &changedFiles) override {
+    if (changedFiles.contains(file)) triggerAsyncUpdate();
+  }
+
+  void handleAsyncUpdate() override {
+    if (ModalComponentManager::getInstance()->getNumModalComponents() > 0) {
+      startTimer(250);
+      return;
+    }
+    auto result = config.reload();
+    if (result.failed()) DBG("AppConfig: not reloading, " << result.getErrorMessage());
+  }
+
+  void timerCallback() override {
+    if (ModalComponentManager::getInstance()->getNumModalComponents() > 0) return;
+    stopTimer();
+    handleAsyncUpdate();
+  }
+
+  AppConfig &config;
+  const File file;
+};
+
+namespace {
+
+String appKey(const AppItem &app) {
+  return app.name + "\n" + app.icon + "\n" + app.shell;
+}
+
+// Apps grouped by a key, a key that is there n times matches n times.
+class AppMatcher {
+public:
+  void add(const String &key, AppItem *app) {
+    if (!bucketByKey.contains(key)) {
+      bucketByKey.set(key, buckets.size());
+      buckets.add(Array<AppItem *>());
+    }
+    buckets.getReference(bucketByKey[key]).add(app);
+  }
+
+  AppItem *take(const String &key) {
+    if (!bucketByKey.contains(key)) return nullptr;
+    auto &bucket = buckets.getReference(bucketByKey[key]);
+    if (bucket.isEmpty()) return nullptr;
+    auto app = bucket.getFirst();
+    bucket.remove(0);
+    return app;
+  }
+
+private:
+  HashMap<String, int> bucketByKey;
+  Array<Array<AppItem *>> buckets;
+};
+
+}
+
+bool AppConfig::Changes::appsChanged() const {
+  return removedApps.size() || addedApps.size() || updatedApps.size() || appsReordered;
+}
+
+bool AppConfig::Changes::isEmpty() const {
+  return !appsChanged() && !backgroundChanged && !clockChanged;
+}
+
+AppConfig &AppConfig::getInstance() {
+  static AppConfig instance;
+  return instance;
+}
+
+AppConfig::AppConfig()
+: writer(new ConfigWriter([this] { return JSON::toString(toJson()); })) {
+  writer->setWriteCallback([this](bool ok) { listeners.call(&Listener::configWritten, ok); });
+}
+
+AppConfig::~AppConfig() {
+  watcher = nullptr;
+}
+
+Result AppConfig::load(const File &configFile) {
+  file = configFile;
+  MemoryBlock data;
+  if (!file.loadFileAsData(data)) {
+    clear();
+    return Result::fail("can't read " + file.getFullPathName());
+  }
+  clear();
+  auto result = Parser(*this, (const char *)data.getData(), data.getSize()).parseDocument();
+  if (result.failed()) clear();
+  return result;
+}
+
+Result AppConfig::loadFromString(const String &text) {
+  clear();
+  auto result = Parser(*this, text.toRawUTF8(), text.getNumBytesAsUTF8()).parseDocument();
+  if (result.failed()) clear();
+  return result;
+}
+
+File AppConfig::getFile() const {
+  return file;
+}
+
+Result AppConfig::reload() {
+  // the file is behind the model until our own write lands, which then reloads as a no-op
+  if (writer->hasUnwrittenChanges()) return Result::ok();
+
+  AppConfig incoming;
+  auto result = incoming.load(file);
+  if (result.failed()) return result;
+
+  Changes changes;
+  changes.backgroundChanged = incoming.getBackground() != getBackground();
+  changes.clockChanged = incoming.isClockShown() != isClockShown() ||
+                         incoming.getTimeFormat() != getTimeFormat();
+  mergeApps(incoming, changes);
+  // anything else is taken as is, and only picked up by pages built from here on
+  root = incoming.root;
+  appsPageIndex = incoming.appsPageIndex;
+
+  if (!changes.isEmpty()) {
+    DBG("AppConfig: reloaded, " << changes.addedApps.size() << " apps added, "
+        << changes.removedApps.size() << " removed, " << changes.updatedApps.size() << " updated");
+    listeners.call(&Listener::configChanged, changes);
+  }
+  return Result::ok();
+}
+
+// Takes over the incoming apps, giving the ones that were already there their old ids.
+void AppConfig::mergeApps(AppConfig &incoming, Changes &changes) {
+  auto &newApps = incoming.apps;
+  // per incoming app, the current entry it carries on, if any
+  Array<AppItem *> matches;
+  matches.insertMultiple(0, nullptr, newApps.size());
+  Array<bool> kept;
+  kept.insertMultiple(0, false, apps.size());
+
+  // unchanged entries first, then ones that kept their name but changed otherwise
+  AppMatcher byContent, byName;
+  for (auto app : apps) byContent.add(appKey(*app), app);
+  for (int i = 0; i < newApps.size(); ++i) {
+    if (auto match = byContent.take(appKey(*newApps[i]))) {
+      matches.set(i, match);
+      kept.set(match->index, true);
+    }
+  }
+  for (auto app : apps) {
+    if (!kept[app->index]) byName.add(app->name, app);
+  }
+  for (int i = 0; i < newApps.size(); ++i) {
+    if (matches[i]) continue;
+    if (auto match = byName.take(newApps[i]->name)) {
+      matches.set(i, match);
+      kept.set(match->index, true);
+      changes.updatedApps.add(match->id);
+    }
+  }
+
+  for (auto app : apps) {
+    if (!kept[app->index]) changes.removedApps.add(app->id);
+  }
+
+  // kept apps are reordered if their old positions don't keep increasing
+  int lastIndex = -1;
+  for (int i = 0; i < newApps.size(); ++i) {
+    if (auto match = matches[i]) {
+      newApps[i]->id = match->id;
+      changes.appsReordered = changes.appsReordered || match->index < lastIndex;
+      lastIndex = match->index;
+    } else {
+      newApps[i]->id = nextId++;
+      changes.addedApps.add(newApps[i]->id);
+    }
+  }
+
+  // the old entries go away with incoming
+  apps.swapWith(newApps);
+  appsById.clear();
+  incoming.appsById.clear();
+  for (int i = 0; i < apps.size(); ++i) {
+    apps[i]->index = i;
+    appsById.set(apps[i]->id, apps[i]);
+  }
+}
+
+void AppConfig::startWatching() {
+  watcher = new Watcher(*this, file);
+}
+
+void AppConfig::stopWatching() {
+  watcher = nullptr;
+}
+
+void AppConfig::addListener(Listener *listener) {
+  listeners.add(listener);
+}
+
+void AppConfig::removeListener(Listener *listener) {
+  listeners.remove(listener);
+}
+
+void AppConfig::clear() {
+  root = var();
+  appsPageIndex = -1;
+  appsById.clear();
+  apps.clear();
+}
+
+bool AppConfig::save() const {
+  // the file itself gets replaced by a rename, only the directory needs to be writable
+  if (file == File::nonexistent || !file.getParentDirectory().hasWriteAccess()) return false;
+  writer->schedule(file);
+  return true;
+}
+
+bool AppConfig::flush() const {
+  return writer->flush();
+}
+
+var AppConfig::appToJson(const AppItem &item) {
+  DynamicObject::Ptr object = new DynamicObject();
+  if (item.complete || item.name.isNotEmpty()) object->setProperty("name", item.name);
+  if (item.complete || item.icon.isNotEmpty()) object->setProperty("icon", item.icon);
+  if (item.complete || item.shell.isNotEmpty()) object->setProperty("shell", item.shell);
+  for (int i = 0; i < item.extraProperties.size(); ++i)
+    object->setProperty(item.extraProperties.getName(i), item.extraProperties.getValueAt(i));
+  return object.get();
+}
+
+var AppConfig::toJson() const {
+  auto rootObject = root.getDynamicObject();
+  DynamicObject::Ptr document = rootObject ? new DynamicObject(*rootObject) : new DynamicObject();
+
+  Array<var> items;
+  for (auto app : apps) items.add(appToJson(*app));
+
+  // shallow copies, only the Apps page itself gets its items put back
+  Array<var> pages;
+  if (auto existing = root["pages"].getArray()) pages = *existing;
+  if (appsPageIndex >= 0) {
+    DynamicObject::Ptr appsPage = new DynamicObject(*pages[appsPageIndex].getDynamicObject());
+    appsPage->setProperty("items", items);
+    pages.set(appsPageIndex, appsPage.get());
+  } else if (!apps.isEmpty()) {
+    DynamicObject::Ptr appsPage = new DynamicObject();
+    appsPage->setProperty("name", "Apps");
+    appsPage->setProperty("items", items);
+    pages.add(appsPage.get());
+  }
+  if (root["pages"].isArray() || !pages.isEmpty()) document->setProperty("pages", pages);
+  return document.get();
+}
+
+String AppConfig::getProperty(const Identifier &name) const {
+  return root[name].toString();
+}
+
+void AppConfig::setProperty(const Identifier &name, const var &value) {
+  if (!root.getDynamicObject()) root = new DynamicObject();
+  root.getDynamicObject()->setProperty(name, value);
+}
+
+String AppConfig::getBackground() const {
+  return getProperty("background");
+}
+
+void AppConfig::setBackground(const String &background) {
+  setProperty("background", background);
+}
+
+bool AppConfig::isClockShown() const {
+  const auto showClock = getProperty("showclock");
+  return showClock.isEmpty() || showClock == "yes";
+}
+
+String AppConfig::getTimeFormat() const {
+  return getProperty("timeformat");
+}
+
+void AppConfig::setTimeFormat(const String &format) {
+  setProperty("timeformat", format);
+}
+
+bool AppConfig::isCursorVisible() const {
+  return getProperty("cursor") == "visible";
+}
+
+void AppConfig::setCursorVisible(bool visible) {
+  setProperty("cursor", visible ? "visible" : "notvisible");
+}
+
+bool AppConfig::isVertical() const {
+  return getProperty("direction") == "VERTICAL";
+}
+
+String AppConfig::getDefaultPage() const {
+  return getProperty("defaultPage");
+}
+
+bool AppConfig::shouldPrewarmPages() const {
+  return getProperty("prewarmPages") != "no";
+}
+
+Array<var> AppConfig::getCornerButtons() const {
+  if (appsPageIndex < 0) return Array<var>();
+  auto buttons = root["pages"][appsPageIndex]["cornerButtons"].getArray();
+  return buttons ? *buttons : Array<var>();
+}
+
+const OwnedArray<AppItem> &AppConfig::getApps() const {
+  return apps;
+}
+
+AppItem *AppConfig::getApp(int id) const {
+  return appsById.contains(id) ? appsById[id] : nullptr;
+}
+
+int AppConfig::adoptApp(AppItem *item) {
+  item->id = nextId++;
+  item->index = apps.size();
+  apps.add(item);
+  appsById.set(item->id, item);
+  return item->id;
+}
+
+int AppConfig::addApp(const String &name, const String &icon, const String &shell) {
+  auto item = new AppItem();
+  item->name = name;
+  item->icon = icon;
+  item->shell = shell;
+  item->complete = true;
+  return adoptApp(item);
+}
+
+bool AppConfig::updateApp(int id, const String &name, const String &icon, const String &shell) {
+  auto item = getApp(id);
+  if (!item) return false;
+  item->name = name;
+  item->icon = icon;
+  item->shell = shell;
+  item->complete = true;
+  return true;
+}
+
+bool AppConfig::removeApp(int id) {
+  auto item = getApp(id);
+  if (!item) return false;
+  const int index = item->index;
+  appsById.remove(id);
+  apps.remove(index);
+  for (int i = index; i < apps.size(); ++i) apps.getUnchecked(i)->index = i;
+  return true;
+}
+
+bool AppConfig::moveApp(int id, int offset) {
+  auto item = getApp(id);
+  if (!item) return false;
+  const int from = item->index, to = from + offset;
+  if (to < 0 || to >= apps.size()) return false;
+  apps.swap(from, to);
+  apps.getUnchecked(from)->index = from;
+  apps.getUnchecked(to)->index = to;
+  return true;
+}
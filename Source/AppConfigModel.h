@@ -0,0 +1,134 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ConfigWriter.h"
+
+// One app icon from the "Apps" page of config.json.
+struct AppItem {
+  // Stable for as long as the entry exists, but only within one session; not written out.
+  int id = 0;
+  // current position in AppConfig::getApps()
+  int index = 0;
+
+  String name, icon, shell;
+  // false if the entry lacks a string name, icon or shell, such entries aren't shown
+  bool complete = false;
+  // anything else the entry holds, written back out untouched
+  NamedValueSet extraProperties;
+};
+
+// The parsed ~/.pocket-home/config.json, shared by every page that reads or edits it.
+// The file is parsed once, in a single pass straight into this model: the app list becomes
+// typed AppItems indexed by id, everything else is kept as-is so it round-trips on save().
+// Looking up, editing or moving an app by id is O(1).
+class AppConfig {
+public:
+  // What a reload() changed. Ids of apps that are still there are kept, so their icons can be.
+  struct Changes {
+    Array<int> removedApps;
+    Array<int> addedApps;
+    // same entry, now with a different icon, shell or the like
+    Array<int> updatedApps;
+    // the apps that were kept are in a different order
+    bool appsReordered = false;
+    bool backgroundChanged = false;
+    // shown or hidden, or a different time format
+    bool clockChanged = false;
+
+    bool appsChanged() const;
+    bool isEmpty() const;
+  };
+
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    // Called on the message thread, after the model has been updated.
+    virtual void configChanged(const Changes &changes) {}
+    // A save() has made it to the file, or failed to. Called on the message thread.
+    virtual void configWritten(bool ok) {}
+  };
+
+  static AppConfig &getInstance();
+  ~AppConfig();
+
+  // Replaces the model with the file's contents. On failure the model is left empty.
+  Result load(const File &file);
+  // Parses JSON text, for load() and for tests.
+  Result loadFromString(const String &text);
+  File getFile() const;
+
+  // Re-reads the loaded file and applies only what differs from the model, then tells the
+  // listeners what changed. A file that doesn't parse is ignored, the model stays as it was.
+  // Skipped while changes of our own are still waiting to be written, those win.
+  Result reload();
+  // Reloads whenever the file is changed by something else, see DirectoryWatcher. Changes
+  // made while a modal component is open are reloaded once it closes.
+  void startWatching();
+  void stopWatching();
+
+  void addListener(Listener *listener);
+  void removeListener(Listener *listener);
+
+  // Queues the model to be written to the loaded file. Changes saved within a short window
+  // of each other are written once, on a background thread (see ConfigWriter).
+  // Returns false if the file can't be written at all.
+  bool save() const;
+  // Writes out any queued change now, call before exiting. Returns false if writing failed.
+  bool flush() const;
+  var toJson() const;
+
+  // Top level settings
+  String getBackground() const;
+  void setBackground(const String &background);
+  bool isClockShown() const;
+  String getTimeFormat() const;
+  void setTimeFormat(const String &format);
+  bool isCursorVisible() const;
+  void setCursorVisible(bool visible);
+  bool isVertical() const;
+  String getDefaultPage() const;
+  bool shouldPrewarmPages() const;
+
+  // The Apps page's "cornerButtons", top left, top right, bottom left, bottom right
+  Array<var> getCornerButtons() const;
+
+  // Apps in display order.
+  const OwnedArray<AppItem> &getApps() const;
+  // nullptr for ids that don't (or no longer) exist
+  AppItem *getApp(int id) const;
+
+  // Appends a new app and returns its id.
+  int addApp(const String &name, const String &icon, const String &shell);
+  bool updateApp(int id, const String &name, const String &icon, const String &shell);
+  bool removeApp(int id);
+  // Swaps the app with its neighbour, offset -1 for the previous one or 1 for the next.
+  bool moveApp(int id, int offset);
+
+private:
+  AppConfig();
+
+  class Parser;
+  class Watcher;
+
+  String getProperty(const Identifier &name) const;
+  void setProperty(const Identifier &name, const var &value);
+  void clear();
+  int adoptApp(AppItem *item);
+  static var appToJson(const AppItem &item);
+  void mergeApps(AppConfig &incoming, Changes &changes);
+
+  File file;
+  // the document, with the Apps page's "items" left as a placeholder for apps below
+  var root;
+  int appsPageIndex = -1;
+
+  OwnedArray<AppItem> apps;
+  HashMap<int, AppItem *> appsById;
+  int nextId = 1;
+
+  ScopedPointer<ConfigWriter> writer;
+  ScopedPointer<Watcher> watcher;
+  ListenerList<Listener> listeners;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AppConfig)
+};
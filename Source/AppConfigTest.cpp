@@ -0,0 +1,327 @@
+// Checks that AppConfig's parser reads config.json the way JSON::parse would, writes back
+// out everything it doesn't model itself, and reports where a broken file goes wrong.
+// Also checks what a reload reports as changed, which decides the icons the launcher keeps.
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AppConfigModel.h"
+
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const String &what) {
+  if (condition) return;
+  std::cerr << "FAILED! " << what << std::endl;
+  failures++;
+}
+
+// Unknown keys at every level, a second page with items of its own, extra properties on an
+// app, an incomplete app, and the trailing commas the stock config.json has.
+const char *const sampleConfig = R"json({
+  "defaultPage": "Apps",
+  "background": "#101010",
+  "someFutureSetting": { "nested": [1, 2.5, -3, true, false, null], "text": "a\"b\\c\/d" },
+  "pages": [
+    {
+      "name": "Apps",
+      "items": [
+        { "name": "Terminal", "icon": "appIcons/terminal.png", "shell": "vala-terminal" },
+        { "name": "Write", "icon": "appIcons/texteditor.png", "shell": "leafpad",
+          "memoryMax": "128M", "cpuWeight": 50, "tags": ["editor", "text"], },
+        { "name": "Half", "icon": "appIcons/half.png" },
+      ],
+      "cornerButtons": [
+        { "location": "TopLeft", "name": "Battery", "icon": "battery_0.png" },
+      ],
+      "layout": "grid",
+    },
+    {
+      "name": "Tools",
+      "items": [
+        { "name": "Wiki", "icon": "appIcons/help.png", "shell": "surf", "url": "x" },
+      ],
+    },
+    "not a page",
+  ],
+})json";
+
+String roundTripped(AppConfig &config) {
+  return JSON::toString(config.toJson());
+}
+
+void testRoundTrip(AppConfig &config) {
+  auto result = config.loadFromString(sampleConfig);
+  expect(result.wasOk(), "sample didn't parse: " + result.getErrorMessage());
+
+  expect(config.getApps().size() == 3, "Apps page should have 3 apps");
+  if (config.getApps().size() == 3) {
+    auto write = config.getApps()[1];
+    expect(write->complete && write->name == "Write", "second app misread");
+    expect(write->extraProperties["memoryMax"] == "128M", "extra property lost");
+    expect((int)write->extraProperties["cpuWeight"] == 50, "numeric extra property lost");
+    expect(!config.getApps()[2]->complete, "app without a shell counted as complete");
+  }
+  expect(config.getBackground() == "#101010", "background misread");
+  expect(config.getCornerButtons().size() == 1, "corner buttons misread");
+
+  // everything, modelled or not, comes back out as JSON::parse reads the same text
+  const auto expected = JSON::toString(JSON::parse(sampleConfig));
+  expect(roundTripped(config) == expected, "round trip differs:\n" + roundTripped(config) +
+                                           "\nexpected:\n" + expected);
+
+  // and survives a second pass through our own output
+  const auto firstPass = roundTripped(config);
+  expect(config.loadFromString(firstPass).wasOk(), "our own output didn't parse");
+  expect(roundTripped(config) == firstPass, "second round trip differs");
+}
+
+void testByteOrderMark(AppConfig &config) {
+  const String withBom = String::fromUTF8("\xef\xbb\xbf") + sampleConfig;
+  auto result = config.loadFromString(withBom);
+  expect(result.wasOk(), "config with a BOM didn't parse: " + result.getErrorMessage());
+  expect(config.getApps().size() == 3, "config with a BOM lost its apps");
+}
+
+void testErrorLine(AppConfig &config, const char *text, int line, const String &what) {
+  auto result = config.loadFromString(text);
+  expect(result.failed(), what + " parsed");
+  expect(result.getErrorMessage().startsWith("config.json line " + String(line) + ":"),
+         what + " reported as: " + result.getErrorMessage());
+  expect(config.getApps().isEmpty(), what + " left apps behind");
+}
+
+void testErrors(AppConfig &config) {
+  testErrorLine(config, "{\n  \"a\": 1,\n  \"b\" 2\n}", 3, "missing colon");
+  testErrorLine(config, "{\n\n\n  \"a\": tru\n}", 4, "bad literal");
+  testErrorLine(config,
+                "{ \"pages\": [\n"
+                "  { \"name\": \"Apps\",\n"
+                "    \"items\": [\n"
+                "      { \"name\": \"x\" \"icon\": \"y\" }\n"
+                "    ]\n"
+                "  }\n"
+                "] }",
+                4, "missing comma in an app");
+  testErrorLine(config, "{\n  \"a\": \"unterminated\n}", 3, "unterminated string");
+  testErrorLine(config, "{ \"a\": 1 }\nextra", 2, "text after the document");
+  testErrorLine(config, "{ \"a\": \"\\u12\" }", 1, "short \\u escape");
+}
+
+String decodeBackground(AppConfig &config, const String &escaped) {
+  auto result = config.loadFromString("{ \"background\": \"" + escaped + "\" }");
+  expect(result.wasOk(), "\"" + escaped + "\" didn't parse: " + result.getErrorMessage());
+  return config.getBackground();
+}
+
+String chars(std::initializer_list<juce_wchar> list) {
+  String text;
+  for (auto c : list) text += String::charToString(c);
+  return text;
+}
+
+void testUnicodeEscapes(AppConfig &config) {
+  expect(decodeBackground(config, "\\u0041\\u00e9\\u20ac") == chars({ 'A', 0xe9, 0x20ac }),
+         "BMP escapes");
+  expect(decodeBackground(config, "\\ud83d\\ude00") == chars({ 0x1f600 }), "surrogate pair");
+  expect(decodeBackground(config, "\\uD83D\\uDE00") == chars({ 0x1f600 }),
+         "upper case surrogate pair");
+  // surrogates that aren't a pair can't be UTF-8, they become U+FFFD
+  expect(decodeBackground(config, "\\ud800x") == chars({ 0xfffd, 'x' }), "lone high surrogate");
+  expect(decodeBackground(config, "\\udc00") == chars({ 0xfffd }), "lone low surrogate");
+  expect(decodeBackground(config, "\\ud800\\u0041") == chars({ 0xfffd, 'A' }),
+         "high surrogate followed by a non-surrogate");
+  expect(decodeBackground(config, "\\ud800\\ud800\\udc00") == chars({ 0xfffd, 0x10000 }),
+         "high surrogate followed by a pair");
+  expect(decodeBackground(config, "\\ud800") == chars({ 0xfffd }),
+         "lone high surrogate at the end");
+  expect(decodeBackground(config, String::fromUTF8("caf\xc3\xa9")) ==
+             chars({ 'c', 'a', 'f', 0xe9 }),
+         "raw UTF-8 text");
+}
+
+// Apps page entries for configWith()
+String app(const String &name, const String &shell, const String &icon = "appIcons/x.png") {
+  return "{ \"name\": \"" + name + "\", \"icon\": \"" + icon + "\", \"shell\": \"" + shell +
+         "\" }";
+}
+
+String appWithoutShell(const String &name, const String &icon = "appIcons/x.png") {
+  return "{ \"name\": \"" + name + "\", \"icon\": \"" + icon + "\" }";
+}
+
+String configWith(std::initializer_list<String> apps) {
+  StringArray items;
+  for (const auto &item : apps) items.add(item);
+  return "{ \"pages\": [ { \"name\": \"Apps\", \"items\": [ " + items.joinIntoString(", ") +
+         " ] } ] }";
+}
+
+Array<int> ids(std::initializer_list<int> list) {
+  Array<int> result;
+  for (auto id : list) result.add(id);
+  return result;
+}
+
+Array<int> appIds(const AppConfig &config) {
+  Array<int> result;
+  for (auto app : config.getApps()) result.add(app->id);
+  return result;
+}
+
+class ChangeRecorder : public AppConfig::Listener {
+public:
+  void configChanged(const AppConfig::Changes &changes) override {
+    last = changes;
+    calls++;
+  }
+
+  AppConfig::Changes last;
+  int calls = 0;
+};
+
+// Rewrites the file and reloads it, returning what the listener was told.
+AppConfig::Changes reloadWith(AppConfig &config, ChangeRecorder &recorder,
+                              std::initializer_list<String> apps) {
+  config.getFile().replaceWithText(configWith(apps));
+  recorder.last = AppConfig::Changes();
+  auto result = config.reload();
+  expect(result.wasOk(), "reload failed: " + result.getErrorMessage());
+  return recorder.last;
+}
+
+void loadWith(AppConfig &config, const File &file, std::initializer_list<String> apps) {
+  file.replaceWithText(configWith(apps));
+  auto result = config.load(file);
+  expect(result.wasOk(), "load failed: " + result.getErrorMessage());
+}
+
+void testAddAndRemove(AppConfig &config, const File &file, ChangeRecorder &recorder) {
+  loadWith(config, file, { app("A", "a"), app("B", "b"), app("C", "c") });
+  const auto before = appIds(config);
+
+  auto changes = reloadWith(config, recorder, { app("A", "a"), app("C", "c"), app("D", "d") });
+  expect(changes.removedApps == ids({ before[1] }), "B should be removed");
+  expect(changes.addedApps.size() == 1 && !before.contains(changes.addedApps[0]),
+         "D should be added with a new id");
+  expect(changes.updatedApps.isEmpty(), "add and remove reported updates");
+  expect(!changes.appsReordered, "add and remove reported a reorder");
+  expect(appIds(config) == ids({ before[0], before[2], changes.addedApps[0] }),
+         "A and C should keep their ids");
+}
+
+void testRenameAndShellChange(AppConfig &config, const File &file, ChangeRecorder &recorder) {
+  loadWith(config, file, { app("A", "a"), app("B", "b") });
+  const auto before = appIds(config);
+
+  // same name, it's still the same app
+  auto changes = reloadWith(config, recorder, { app("A", "a --new"), app("B", "b") });
+  expect(changes.updatedApps == ids({ before[0] }), "shell change should update A");
+  expect(changes.addedApps.isEmpty() && changes.removedApps.isEmpty(),
+         "shell change reported as add or remove");
+  expect(config.getApp(before[0]) && config.getApp(before[0])->shell == "a --new",
+         "A's new shell wasn't taken");
+
+  changes = reloadWith(config, recorder, { app("A", "a --new", "appIcons/y.png"), app("B", "b") });
+  expect(changes.updatedApps == ids({ before[0] }), "icon change should update A");
+
+  // a new name is a new entry, even with the same shell and icon
+  changes = reloadWith(config, recorder, { app("Z", "a --new", "appIcons/y.png"), app("B", "b") });
+  expect(changes.removedApps == ids({ before[0] }), "rename should remove A");
+  expect(changes.addedApps.size() == 1, "rename should add Z");
+  expect(changes.updatedApps.isEmpty(), "rename reported as an update");
+  expect(!changes.appsReordered, "rename reported a reorder");
+}
+
+void testDuplicates(AppConfig &config, const File &file, ChangeRecorder &recorder) {
+  loadWith(config, file, { app("A", "a"), app("A", "a"), app("B", "b") });
+  const auto before = appIds(config);
+
+  // the first of two identical entries is the one that stays
+  auto changes = reloadWith(config, recorder, { app("A", "a"), app("B", "b") });
+  expect(changes.removedApps == ids({ before[1] }), "one duplicate should be removed");
+  expect(changes.addedApps.isEmpty() && changes.updatedApps.isEmpty(),
+         "removing a duplicate reported adds or updates");
+  expect(!changes.appsReordered, "removing a duplicate reported a reorder");
+  expect(appIds(config) == ids({ before[0], before[2] }), "A and B should keep their ids");
+
+  changes = reloadWith(config, recorder, { app("A", "a"), app("A", "a"), app("A", "a"),
+                                           app("B", "b") });
+  expect(changes.addedApps.size() == 2, "two more duplicates should be added");
+  expect(changes.removedApps.isEmpty() && changes.updatedApps.isEmpty(),
+         "adding duplicates reported removes or updates");
+  expect(appIds(config)[0] == before[0] && appIds(config)[3] == before[2],
+         "existing entries should keep their ids");
+
+  // two entries of one name, only one of them changed
+  loadWith(config, file, { app("A", "a"), app("A", "a --other") });
+  const auto pair = appIds(config);
+  changes = reloadWith(config, recorder, { app("A", "a"), app("A", "a --changed") });
+  expect(changes.updatedApps == ids({ pair[1] }), "only the changed duplicate should update");
+  expect(appIds(config) == pair, "duplicates should keep their ids");
+}
+
+void testReorder(AppConfig &config, const File &file, ChangeRecorder &recorder) {
+  loadWith(config, file, { app("A", "a"), app("B", "b"), app("C", "c") });
+  const auto before = appIds(config);
+
+  auto changes = reloadWith(config, recorder, { app("C", "c"), app("A", "a"), app("B", "b") });
+  expect(changes.appsReordered, "reorder not reported");
+  expect(changes.addedApps.isEmpty() && changes.removedApps.isEmpty() &&
+             changes.updatedApps.isEmpty(),
+         "a pure reorder reported other changes");
+  expect(appIds(config) == ids({ before[2], before[0], before[1] }), "reorder changed ids");
+
+  // nothing changed, nobody is told
+  const int calls = recorder.calls;
+  reloadWith(config, recorder, { app("C", "c"), app("A", "a"), app("B", "b") });
+  expect(recorder.calls == calls, "unchanged file notified listeners");
+}
+
+void testBecomesIncomplete(AppConfig &config, const File &file, ChangeRecorder &recorder) {
+  loadWith(config, file, { app("A", "a"), app("B", "b") });
+  const auto before = appIds(config);
+
+  auto changes = reloadWith(config, recorder, { appWithoutShell("A"), app("B", "b") });
+  expect(changes.updatedApps == ids({ before[0] }), "A losing its shell should update it");
+  expect(changes.removedApps.isEmpty(), "incomplete A was removed from the model");
+  expect(config.getApp(before[0]) && !config.getApp(before[0])->complete,
+         "A should now be incomplete");
+
+  changes = reloadWith(config, recorder, { app("A", "a"), app("B", "b") });
+  expect(changes.updatedApps == ids({ before[0] }), "A getting its shell back should update it");
+  expect(config.getApp(before[0]) && config.getApp(before[0])->complete,
+         "A should be complete again");
+}
+
+}
+
+int main() {
+  ScopedJuceInitialiser_GUI juce;
+  auto &config = AppConfig::getInstance();
+
+  testRoundTrip(config);
+  testByteOrderMark(config);
+  testErrors(config);
+  testUnicodeEscapes(config);
+
+  TemporaryFile directory;
+  directory.getFile().createDirectory();
+  const auto file = directory.getFile().getChildFile("config.json");
+  ChangeRecorder recorder;
+  config.addListener(&recorder);
+  testAddAndRemove(config, file, recorder);
+  testRenameAndShellChange(config, file, recorder);
+  testDuplicates(config, file, recorder);
+  testReorder(config, file, recorder);
+  testBecomesIncomplete(config, file, recorder);
+  config.removeListener(&recorder);
+  directory.getFile().deleteRecursively();
+
+  if (failures) {
+    std::cerr << failures << " checks failed" << std::endl;
+    return 1;
+  }
+  std::cout << "app config OK" << std::endl;
+  return 0;
+}
@@ -3,16 +3,12 @@
 #include "PokeLookAndFeel.h"
 #include "Main.h"
 #include "Utils.h"
+#include "KeymapSync.h"
+#include "AppCgroups.h"
+#include "SharedImageCache.h"
 
 using namespace std; 
 
-void AppCheckTimer::timerCallback() {
-  DBG("AppCheckTimer::timerCallback - check running apps");
-  if (appsPage) {
-    appsPage->checkRunningApps();
-  }
-}
-
 void AppDebounceTimer::timerCallback() {
   DBG("AppDebounceTimer::timerCallback - check launch debounce");
   if (appsPage) {
@@ -21,17 +17,72 @@ void AppDebounceTimer::timerCallback() {
   stopTimer();
 }
 
-AppIconButton::AppIconButton(const String &label, const String &shell, const Drawable *image)
+AppIconButton::AppIconButton(const String &label, const String &shell, const File &iconFile)
 : DrawableButton(label, DrawableButton::ImageAboveTextLabel),
-  shell(shell) {
-  // FIXME: supposedly setImages will "create internal copies of its drawables"
-  // this relates to AppsPageComponent ownership of drawable icons ... docs are unclear
-  setImages(image);
+  shell(shell),
+  iconFile(iconFile) {}
+
+AppIconButton::~AppIconButton() {
+  IconLoader::getInstance().cancelRequests(this);
+}
+
+void AppIconButton::setIconFile(const File &file) {
+  iconFile = file;
+  iconSize = Rectangle<int>();
+  rasterizeIcon();
+}
+
+const File &AppIconButton::getIconFile() const {
+  return iconFile;
+}
+
+void AppIconButton::setOnVisiblePage(bool visible) {
+  onVisiblePage = visible;
+  IconLoader::getInstance().setVisible(this, visible);
 }
 
 Rectangle<float> AppIconButton::getImageBounds() const {
   auto bounds = getLocalBounds();
-  return bounds.withHeight(PokeLookAndFeel::getDrawableButtonImageHeightForBounds(bounds)).toFloat();
+  // whole pixels, so the icon rasterized for these bounds is drawn without any scaling
+  const int imageHeight = (int)PokeLookAndFeel::getDrawableButtonImageHeightForBounds(bounds);
+  return bounds.withHeight(jmax(0, imageHeight)).toFloat();
+}
+
+void AppIconButton::resized() {
+  DrawableButton::resized();
+  rasterizeIcon();
+}
+
+void AppIconButton::rasterizeIcon() {
+  auto bounds = getImageBounds().getSmallestIntegerContainer().withZeroOrigin();
+  if (bounds.isEmpty() || bounds == iconSize) return;
+  iconSize = bounds;
+
+  // show a placeholder until the decoded icon comes back from the IconLoader
+  setIconImage(IconLoader::getPlaceholder(iconSize.getWidth(), iconSize.getHeight()));
+  IconLoader::getInstance().requestIcon(this, iconFile, iconSize.getWidth(),
+                                        iconSize.getHeight(), onVisiblePage);
+}
+
+void AppIconButton::setIconImage(const Image &image) {
+  // setImages() takes its own copy of the drawable, the pixels themselves stay shared
+  DrawableImage drawable;
+  drawable.setImage(image);
+  setImages(&drawable);
+}
+
+void AppIconButton::iconLoaded(const File &file, int width, int height, const Image &image) {
+  // stale result, the icon or its size changed while it was decoding
+  if (file != iconFile || width != iconSize.getWidth() || height != iconSize.getHeight()) return;
+
+  if (image.isValid()) {
+    setIconImage(image);
+    // the placeholder, or the icon at its previous size
+    SharedImageCache::getInstance().releaseUnusedSoon();
+  } else {
+    auto defaultIcon = assetFile("appIcons/default.png");
+    if (iconFile != defaultIcon) setIconFile(defaultIcon);
+  }
 }
 
 AppListComponent::AppListComponent(Component* parent, bool ishorizontal) :
@@ -41,9 +92,9 @@ AppListComponent::AppListComponent(Component* parent, bool ishorizontal) :
   string previcn = (direction==HORIZONTAL)?"backIcon.png":"pageUpIcon.png";
   string nexticn = (direction==HORIZONTAL)?"nextIcon.png":"pageDownIcon.png";
   prevPageBtn = createImageButton("PrevAppsPage",
-                                  ImageFileFormat::loadFrom(assetFile(previcn)));
+                                  createImageFromFile(assetFile(previcn)));
   nextPageBtn = createImageButton("NextAppsPage",
-                                  ImageFileFormat::loadFrom(assetFile(nexticn)));
+                                  createImageFromFile(assetFile(nexticn)));
 
   
   if(!parent) parent = this;
@@ -70,23 +121,19 @@ void AppListComponent::previous(){
 }
 
 DrawableButton *AppListComponent::createAndOwnIcon(const String &name, const String &iconPath, const String &shell) {
-  File icon = assetFile(iconPath);
-  Image image;
-  if(iconPath == "" || !icon.exists() || icon.getSize()==0)
-    image = createImageFromFile(assetFile("appIcons/default.png"));
-  else
-    image = createImageFromFile(icon);
-  auto drawable = new DrawableImage();
-  drawable->setImage(image);
-  // FIXME: is this OwnedArray for the drawables actually necessary?
-  // won't the AppIconButton correctly own the drawable?
-  // Further we don't actually use this list anywhere.
-  iconDrawableImages.add(drawable);
-  auto button = new AppIconButton(name, shell, drawable);
+  // missing or broken icons fall back to the default one once the IconLoader gives up on them
+  File icon = assetFile(iconPath == "" ? String("appIcons/default.png") : iconPath);
+  auto button = new AppIconButton(name, shell, icon);
   addAndOwnIcon(name, button);
   return button;
 }
 
+DrawableButton *AppListComponent::createAndOwnIcon(const AppItem &app) {
+  auto button = createAndOwnIcon(app.name, app.icon, app.shell);
+  ((AppIconButton *)button)->appId = app.id;
+  return button;
+}
+
 void AppListComponent::resized() {
   auto b = getLocalBounds();
   
@@ -108,9 +155,28 @@ void AppListComponent::resized() {
   grid->setSize(gridWidth, gridHeight);
   grid->setBoundsToFit(b.getX(), b.getY(), b.getWidth(), b.getHeight(), Justification::centred, true);
   
+  updateIconPriorities();
+}
+
+void AppListComponent::updateIconPriorities() {
+  // Only the current grid page gets laid out. Give icons on the other pages the same cell
+  // size so they start loading too, behind the ones on screen.
+  auto current = grid->page;
+  Rectangle<int> cellSize;
+  if (current && current->items.size()) cellSize = current->items[0]->getLocalBounds();
+
+  for (auto icon : gridIcons) {
+    auto appIcon = dynamic_cast<AppIconButton *>(icon);
+    if (!appIcon) continue;
+    const bool visible = current && current->items.contains(icon);
+    appIcon->setOnVisiblePage(visible);
+    if (!visible && !cellSize.isEmpty()) appIcon->setSize(cellSize.getWidth(), cellSize.getHeight());
+  }
 }
 
 void AppListComponent::checkShowPageNav() {
+  updateIconPriorities();
+
   if (grid->hasNextPage()) {
     nextPageBtn->setVisible(true); nextPageBtn->setEnabled(true);
   }
@@ -138,18 +204,13 @@ void AppListComponent::removeIcon(Component* icon){
   grid->removeItem(icon);
 }
 
-Array<DrawableButton *> AppListComponent::createIconsFromJsonArray(const var &json) {
+Array<DrawableButton *> AppListComponent::createIconsFromConfig(const AppConfig &config) {
   Array<DrawableButton *> buttons;
-  if (json.isArray()) {
-    for (const auto &item : *json.getArray()) {
-      auto name = item["name"];
-      auto shell = item["shell"];
-      auto iconPath = item["icon"];
-      if (name.isString() && shell.isString() && iconPath.isString()) {
-        auto icon = createAndOwnIcon(name, iconPath, shell);
-        if (icon) {
-          buttons.add(icon);
-        }
+  for (auto app : config.getApps()) {
+    if (app->complete) {
+      auto icon = createAndOwnIcon(*app);
+      if (icon) {
+        buttons.add(icon);
       }
     }
   }
@@ -158,15 +219,67 @@ Array<DrawableButton *> AppListComponent::createIconsFromJsonArray(const var &js
   return buttons;
 }
 
+void AppListComponent::applyConfigChanges(const AppConfig &config, const AppConfig::Changes &changes) {
+  if (!changes.appsChanged()) return;
+
+  HashMap<int, AppIconButton *> iconsById;
+  for (auto icon : gridIcons) {
+    auto button = dynamic_cast<AppIconButton *>(icon);
+    if (button && button->appId) iconsById.set(button->appId, button);
+  }
+
+  for (auto id : changes.removedApps) {
+    if (iconsById.contains(id)) {
+      gridIcons.removeObject(iconsById[id]);
+      iconsById.remove(id);
+    }
+  }
+
+  for (auto id : changes.updatedApps) {
+    auto app = config.getApp(id);
+    if (!iconsById.contains(id) || !app) continue;
+    auto button = iconsById[id];
+    if (!app->complete) {
+      gridIcons.removeObject(button);
+      iconsById.remove(id);
+      continue;
+    }
+    button->setName(app->name);
+    button->setButtonText(app->name);
+    button->shell = app->shell;
+    button->setIconFile(assetFile(app->icon == "" ? String("appIcons/default.png") : app->icon));
+  }
+
+  // new icons go on the grid in config order below, along with the rest
+  Array<Component *> order;
+  for (auto app : config.getApps()) {
+    if (!app->complete) continue;
+    AppIconButton *button = iconsById.contains(app->id) ? iconsById[app->id] : nullptr;
+    if (!button) {
+      button = (AppIconButton *)createAndOwnIcon(*app);
+      button->setWantsKeyboardFocus(false);
+    }
+    order.add(button);
+  }
+  // anything not made from the config, like the apps library button, stays at the end
+  for (auto icon : gridIcons) {
+    if (!order.contains(icon)) order.add(icon);
+  }
+
+  grid->setItems(order);
+  checkShowPageNav();
+  updateIconPriorities();
+}
+
 AppsPageComponent::AppsPageComponent(LauncherComponent* launcherComponent, bool horizontal) :
   AppListComponent(launcherComponent, horizontal),
   launcherComponent(launcherComponent),
-  runningCheckTimer(),
   debounceTimer(),
   x(-1), y(-1), shouldMove(false)
 {
-  runningCheckTimer.appsPage = this;
   debounceTimer.appsPage = this;
+  ProcessSupervisor::getInstance().addListener(this);
+  LaunchTelemetry::getInstance().addListener(this);
   cpy = nullptr;
   
   //Trash Icon
@@ -181,10 +294,14 @@ AppsPageComponent::AppsPageComponent(LauncherComponent* launcherComponent, bool
   setWantsKeyboardFocus(true);
 }
 
-AppsPageComponent::~AppsPageComponent() {}
+AppsPageComponent::~AppsPageComponent() {
+  IconLoader::getInstance().cancelRequests(this);
+  ProcessSupervisor::getInstance().removeListener(this);
+  LaunchTelemetry::getInstance().removeListener(this);
+}
 
-Array<DrawableButton *> AppsPageComponent::createIconsFromJsonArray(const var &json) {
-  auto buttons = AppListComponent::createIconsFromJsonArray(json);
+Array<DrawableButton *> AppsPageComponent::createIconsFromConfig(const AppConfig &config) {
+  auto buttons = AppListComponent::createIconsFromConfig(config);
   
   //// hard coded "virtual" application. Cannot be removed.
   //appsLibraryBtn = createAndOwnIcon("App Get", "appIcons/update.png", String::empty);
@@ -194,15 +311,30 @@ Array<DrawableButton *> AppsPageComponent::createIconsFromJsonArray(const var &j
   return buttons;
 }
 
-void AppsPageComponent::startApp(AppIconButton* appButton) {
+void AppsPageComponent::applyConfigChanges(const AppConfig &config, const AppConfig::Changes &changes) {
+  // running apps are tracked by button, forget the ones whose button is about to go
+  for (auto icon : gridIcons) {
+    auto button = dynamic_cast<AppIconButton *>(icon);
+    if (!button) continue;
+    auto app = config.getApp(button->appId);
+    if (button->appId && (!app || !app->complete)) runningAppsByButton.remove(button);
+  }
+  AppListComponent::applyConfigChanges(config, changes);
+}
+
+void AppsPageComponent::startApp(AppIconButton* appButton, double tapMs) {
   DBG("AppsPageComponent::startApp - " << appButton->shell);
-  ChildProcess* launchApp = new ChildProcess();
-  launchApp->start("xmodmap ${HOME}/.Xmodmap"); // Reload xmodmap to ensure it's running
-  if (launchApp->start(appButton->shell)) {
-    runningApps.add(launchApp);
-    runningAppsByButton.set(appButton, runningApps.indexOf(launchApp));
-    // FIXME: uncomment when process running check works
-    // runningCheckTimer.startTimer(5 * 1000);
+  // Reapply ~/.Xmodmap in case something has reset the keymap, a no-op when nothing has
+  KeymapSync::getInstance().ensureApplied();
+  // in a cgroup of its own, with the limits its config entry asks for
+  auto app = AppConfig::getInstance().getApp(appButton->appId);
+  const auto limits = app ? AppCgroups::Limits::forApp(*app) : AppCgroups::Limits();
+  const int pid = AppCgroups::getInstance().launch(appButton->shell, appButton->getName(), limits);
+  if (pid > 0) {
+    runningAppsByButton.set(appButton, pid);
+    launchingPid = pid;
+    // the spinner stays up until the app's first window is listed, see launchFinished()
+    LaunchTelemetry::getInstance().launchStarted(pid, appButton->shell, tapMs);
     
     debounce = true;
     debounceTimer.startTimer(2 * 1000);
@@ -213,40 +345,42 @@ void AppsPageComponent::startApp(AppIconButton* appButton) {
   }
 };
 
-void AppsPageComponent::focusApp(AppIconButton* appButton, const String& windowId) {
+void AppsPageComponent::focusApp(AppIconButton* appButton, WindowTracker::WindowId window) {
   DBG("AppsPageComponent::focusApp - " << appButton->shell);
-  String focusShell = "echo 'focus_client_by_window_id("+windowId+")' | awesome-client";
-  StringArray focusCmd{"sh", "-c", focusShell.toRawUTF8()};
-  ChildProcess focusWindow;
-  focusWindow.start(focusCmd);
+  // EWMH client messages on the tracker's X connection, no shell or awesome-client round trip
+  WindowTracker::getInstance().activateWindow(window);
 };
 
 void AppsPageComponent::startOrFocusApp(AppIconButton* appButton) {
   if (debounce) return;
   
+  const double tapMs = Time::getMillisecondCounterHiRes();
   bool shouldStart = true;
-  int appIdx = runningAppsByButton[appButton];
-  bool hasLaunched = runningApps[appIdx] != nullptr;
-  String windowId;
+  bool hasLaunched = runningAppsByButton.contains(appButton) &&
+                     ProcessSupervisor::getInstance().isRunning(runningAppsByButton[appButton]);
+  WindowTracker::WindowId window = 0;
   
   if(hasLaunched) {
-    const auto shellWords = split(appButton->shell, " ");
-    const auto& cmdName = shellWords[0];
-    StringArray findCmd{"xdotool", "search", "--all", "--limit", "1", "--class", cmdName.toRawUTF8()};
-    ChildProcess findWindow;
-    findWindow.start(findCmd);
-    findWindow.waitForProcessToFinish(1000);
-    windowId = findWindow.readAllProcessOutput().trimEnd();
+    // in-memory lookups, the tracker follows the window list on its own X connection.
+    // By the pid we started; WM_CLASS only finds windows that don't say whose they are,
+    // so another instance of the same program isn't taken for ours.
+    auto &tracker = WindowTracker::getInstance();
+    window = tracker.findWindowByPid(runningAppsByButton[appButton]);
+    if (!window) {
+      const auto shellWords = split(appButton->shell, " ");
+      const auto cmdName = shellWords[0].fromLastOccurrenceOf("/", false, false);
+      window = tracker.findWindowByClass(cmdName);
+    }
     
-    // does xdotool find a window id? if so, we shouldn't start a new one
-    shouldStart = (windowId.length() > 0) ? false : true;
+    // is there a window for it already? if so, we shouldn't start a new one
+    shouldStart = window == 0;
   }
   
   if (shouldStart) {
-    startApp(appButton);
+    startApp(appButton, tapMs);
   }
   else {
-    focusApp(appButton, windowId);
+    focusApp(appButton, window);
   }
   
 };
@@ -255,27 +389,17 @@ void AppsPageComponent::openAppsLibrary() {
   launcherComponent->showAppsLibrary();
 }
 
-void AppsPageComponent::checkRunningApps() {
-  Array<int> needsRemove{};
-  
-  // check list to mark any needing removal
-  for (const auto& cp : runningApps) {
-    if (!cp->isRunning()) {
-      needsRemove.add(runningApps.indexOf(cp));
-    }
-  }
-  
-  // cleanup list
-  for (const auto appIdx : needsRemove) {
-    runningApps.remove(appIdx);
-    runningAppsByButton.removeValue(appIdx);
-  }
-  
-  if (!runningApps.size()) {
-    // FIXME: uncomment when process running check works
-    // runningCheckTimer.stopTimer();
-    launcherComponent->hideLaunchSpinner();
-  }
+void AppsPageComponent::processExited(const ProcessSupervisor::ExitInfo &info) {
+  // xmodmap and the like aren't in the map
+  if (!runningAppsByButton.containsValue(info.pid)) return;
+  runningAppsByButton.removeValue(info.pid);
+};
+
+void AppsPageComponent::launchFinished(int pid, bool windowShown) {
+  // a window showed up, or the app exited or timed out without one
+  if (pid != launchingPid) return;
+  launchingPid = 0;
+  launcherComponent->hideLaunchSpinner();
 };
 
 void AppsPageComponent::buttonStateChanged(Button* btn) {
@@ -300,8 +424,13 @@ void AppsPageComponent::buttonStateChanged(Button* btn) {
     auto parentPos = launcherComponent->getScreenPosition();
     boundsNext.setPosition(boundsNext.getPosition() - parentPos);
     
-    // show popup icon, hide real button beneath
+    // show popup icon, hide real button beneath. The icon already loaded stands in until the
+    // IconLoader has one at the popup's size, so the popup doesn't rescale it on every paint.
     buttonPopup->setImage(appIcon->getImage());
+    popupIconFile = appBtn->getIconFile();
+    popupIconSize = boundsNext.withZeroOrigin();
+    IconLoader::getInstance().requestIcon(this, popupIconFile, popupIconSize.getWidth(),
+                                          popupIconSize.getHeight(), true);
     buttonPopup->setBounds(boundsNext);
     buttonPopup->setVisible(true);
     appIcon->setVisible(false);
@@ -312,9 +441,23 @@ void AppsPageComponent::buttonStateChanged(Button* btn) {
     appIcon->setVisible(true);
     appBtn->setColour(DrawableButton::textColourId, getLookAndFeel().findColour(DrawableButton::textColourId));
     buttonPopup->setVisible(false);
+    // the popup sized icon isn't kept around between presses
+    IconLoader::getInstance().cancelRequests(this);
+    popupIconFile = File();
+    buttonPopup->setImage(Image());
+    SharedImageCache::getInstance().releaseUnusedSoon();
   }
 }
 
+void AppsPageComponent::iconLoaded(const File &file, int width, int height, const Image &image) {
+  // stale, the popup has been hidden or shown for another icon since
+  if (file != popupIconFile || width != popupIconSize.getWidth() ||
+      height != popupIconSize.getHeight() || !image.isValid())
+    return;
+  auto buttonPopup = launcherComponent->focusButtonPopup.get();
+  if (buttonPopup->isVisible()) buttonPopup->setImage(image);
+}
+
 void AppsPageComponent::mouseDrag(const MouseEvent& me){
   if(me.originalComponent == this ||
      me.getLengthOfMousePress() < 500) return;
@@ -370,7 +513,7 @@ void AppsPageComponent::onTrash(Button* button){
                                  );
     if(answer){
         auto appButton = (AppIconButton*) button;
-        launcherComponent->deleteIcon(button->getName(), appButton->shell, appButton);
+        launcherComponent->deleteIcon(appButton);
     }
 }
 
@@ -456,62 +599,28 @@ void AppsPageComponent::mouseUp(const MouseEvent& me){
 /* left is true if the current icon has to be switched 
  * with the one on its left */
 void AppsPageComponent::moveInConfig(AppIconButton* icon, bool left){
-  //Get the global configuration
-  var json = getConfigJSON();
-  Array<var>* pages_arr = (json["pages"].getArray());
-  const var& pages = ((*pages_arr)[0]);
-  Array<var>* items_arr = pages["items"].getArray();
-  
-  //Offset of the icon to switch with
-  int nxtoffset = left?-1:1;
-  //Searching for the element in the Array
-  for(int i = 0; i < items_arr->size(); i++){
-    const var& elt = (*items_arr)[i];
-    if(elt["name"] == icon->getName() && elt["shell"] == icon->shell){
-      items_arr->swap(i, i+nxtoffset);
-      break;
-    }
-  }
-  
-  //Write the config object to the file
-  File config = getConfigFile();
-  DynamicObject* obj = json.getDynamicObject();
-  String s = JSON::toString(json);
-  config.replaceWithText(s);
+  auto &config = AppConfig::getInstance();
+  //Swap with the neighbour, and write the config to the file
+  if(config.moveApp(icon->appId, left ? -1 : 1))
+    config.save();
 }
 
 void AppsPageComponent::updateIcon(AppIconButton* icon, EditWindow* ew){
-  //Get the global configuration
-  var json = getConfigJSON();
-  Array<var>* pages_arr = (json["pages"].getArray());
-  const var& pages = ((*pages_arr)[0]);
-  Array<var>* items_arr = pages["items"].getArray();
+  auto &config = AppConfig::getInstance();
+  auto app = config.getApp(icon->appId);
+  if(!app) return;
   
-  //Searching for the element in the Array
-  for(int i = 0; i < items_arr->size(); i++){
-    const var& elt = (*items_arr)[i];
-    if(elt["name"] == icon->getName() && elt["shell"] == icon->shell){
-      DynamicObject* new_elt = elt.getDynamicObject();
-      new_elt->setProperty("name",  ew->getName());
-      icon->setName(ew->getName());
-      new_elt->setProperty("shell", ew->getShell());
-      icon->shell = ew->getShell();
-      if(ew->getIcon() != ""){
-	new_elt->setProperty("icon", ew->getIcon());
-	Image img = createImageFromFile(ew->getIcon());
-	DrawableImage newicn;
-	newicn.setImage(img);
-	icon->setImages(&newicn);
-      }
-      break;
-    }
+  icon->setName(ew->getName());
+  icon->shell = ew->getShell();
+  String iconPath = app->icon;
+  if(ew->getIcon() != ""){
+    iconPath = ew->getIcon();
+    icon->setIconFile(assetFile(iconPath));
   }
   
-  //Write the config object to the file
-  File config = getConfigFile();
-  DynamicObject* obj = json.getDynamicObject();
-  String s = JSON::toString(json);
-  config.replaceWithText(s);
+  //Write the config to the file
+  config.updateApp(icon->appId, ew->getName(), iconPath, ew->getShell());
+  config.save();
 }
 
 void AppsPageComponent::manageChoice(AppIconButton* icon, int choice){
@@ -638,19 +747,8 @@ browse("..."), choice(0)
   addAndMakeVisible(browse);
   
   //Looking for the image path
-  var json = getConfigJSON();
-  Array<var>* pages_arr = (json["pages"].getArray());
-  const var& pages = ((*pages_arr)[0]);
-  Array<var>* items_arr = pages["items"].getArray();
-  
-  //Searching for the element in the Array
-  for(int i = 0; i < items_arr->size(); i++){
-    const var& elt = (*items_arr)[i];
-    if(elt["name"] == button->getName() && elt["shell"] == button->shell){
-      icon.setText(elt["icon"]);
-      break;
-    }
-  }
+  if(auto app = AppConfig::getInstance().getApp(button->appId))
+    icon.setText(app->icon);
 }
 
 EditWindow::~EditWindow(){ }
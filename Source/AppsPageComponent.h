@@ -3,18 +3,15 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #include "Grid.h"
+#include "IconLoader.h"
+#include "AppConfigModel.h"
+#include "WindowTracker.h"
+#include "ProcessSupervisor.h"
+#include "LaunchTelemetry.h"
 
 class AppsPageComponent;
 class LauncherComponent;
 
-class AppCheckTimer : public Timer {
-public:
-  AppCheckTimer() {};
-  virtual void timerCallback() override;
-  // TODO: better pointer usage, weakref for cycle relationship?
-  AppsPageComponent* appsPage;
-};
-
 class AppDebounceTimer : public Timer {
 public:
   AppDebounceTimer() {};
@@ -23,13 +20,31 @@ public:
   AppsPageComponent* appsPage;
 };
 
-class AppIconButton : public DrawableButton {
+class AppIconButton : public DrawableButton, private IconLoader::Listener {
 public:
-  AppIconButton(const String &label, const String &shell, const Drawable *image);
+  AppIconButton(const String &label, const String &shell, const File &iconFile);
+  ~AppIconButton();
   
   String shell;
+  // the AppConfig entry this icon was made from, 0 if none
+  int appId = 0;
   
+  void setIconFile(const File &iconFile);
+  const File &getIconFile() const;
+  // whether this icon sits on the grid page currently shown, visible icons load first
+  void setOnVisiblePage(bool onVisiblePage);
   Rectangle<float> getImageBounds() const override;
+  void resized() override;
+
+private:
+  // the icon is decoded straight to the size it's drawn at, and again only when that changes
+  void rasterizeIcon();
+  void setIconImage(const Image &image);
+  void iconLoaded(const File &file, int width, int height, const Image &image) override;
+
+  File iconFile;
+  Rectangle<int> iconSize;
+  bool onVisiblePage = true;
 };
 
 enum NavDirection{
@@ -45,21 +60,25 @@ public:
   ScopedPointer<Grid> grid;
   
   OwnedArray<Component> gridIcons;
-  OwnedArray<DrawableImage> iconDrawableImages;
   ScopedPointer<ImageButton> nextPageBtn;
   ScopedPointer<ImageButton> prevPageBtn;
   
   void resized() override;
   void checkShowPageNav();
+  void updateIconPriorities();
   
   void next();
   void previous();
   
   void addAndOwnIcon(const String &name, Component *icon);
   DrawableButton *createAndOwnIcon(const String &name, const String &iconPath, const String &shell);
+  DrawableButton *createAndOwnIcon(const AppItem &app);
   
   void removeIcon(Component*);
-  virtual Array<DrawableButton *> createIconsFromJsonArray(const var &json);
+  virtual Array<DrawableButton *> createIconsFromConfig(const AppConfig &config);
+  // Brings the icons in line with a reloaded config. Icons of apps that are still there are
+  // kept as they are, only added, removed or changed ones are touched.
+  virtual void applyConfigChanges(const AppConfig &config, const AppConfig::Changes &changes);
   
   void buttonStateChanged(Button*) override {};
   void buttonClicked(Button *button) override {};
@@ -108,14 +127,14 @@ private:
   bool choice;
 };
 
-class AppsPageComponent : public AppListComponent{
+class AppsPageComponent : public AppListComponent, private ProcessSupervisor::Listener,
+                          private LaunchTelemetry::Listener, private IconLoader::Listener{
 public:
   AppsPageComponent(LauncherComponent* launcherComponent, bool);
   ~AppsPageComponent();
   
-  Array<DrawableButton *> createIconsFromJsonArray(const var &json) override;
-  
-  OwnedArray<ChildProcess> runningApps;
+  Array<DrawableButton *> createIconsFromConfig(const AppConfig &config) override;
+  void applyConfigChanges(const AppConfig &config, const AppConfig::Changes &changes) override;
   
   virtual void buttonStateChanged(Button*) override;
   void buttonClicked(Button *button) override;
@@ -124,11 +143,10 @@ public:
   void mouseUp(const MouseEvent&) override;
   bool keyPressed (const KeyPress &) override;
   
-  void checkRunningApps();
-  
   bool debounce = false;
 
 private:
+  // pid of the app each button launched, while it runs
   using AppRunningMap = HashMap<AppIconButton*, int>;
   ScopedPointer<Drawable> cpy;
 
@@ -136,12 +154,20 @@ private:
   LauncherComponent* launcherComponent;
   
   AppRunningMap runningAppsByButton;
-  AppCheckTimer runningCheckTimer;
+  // the most recent launch, the one the spinner is shown for
+  int launchingPid = 0;
   AppDebounceTimer debounceTimer;
+  // the icon file and size the press popup is waiting on from the IconLoader
+  File popupIconFile;
+  Rectangle<int> popupIconSize;
 
+  void processExited(const ProcessSupervisor::ExitInfo &info) override;
+  void launchFinished(int pid, bool windowShown) override;
+  void iconLoaded(const File &file, int width, int height, const Image &image) override;
   void onTrash(Button*);
-  void startApp(AppIconButton* appButton);
-  void focusApp(AppIconButton* appButton, const String& windowId);
+  // tapMs is Time::getMillisecondCounterHiRes() when the icon was tapped
+  void startApp(AppIconButton* appButton, double tapMs);
+  void focusApp(AppIconButton* appButton, WindowTracker::WindowId window);
   void startOrFocusApp(AppIconButton* appButton);
   void openAppsLibrary();
   void updateIcon(AppIconButton*, EditWindow*);
@@ -0,0 +1,91 @@
+#include "AssetResolver.h"
+#include "Utils.h"
+
+AssetResolver &AssetResolver::getInstance() {
+  static AssetResolver instance;
+  return instance;
+}
+
+AssetResolver::AssetResolver() : DirectoryWatcher("AssetResolver") {
+  // highest priority first
+  searchPath.add(absoluteFileFromPath("~/.pocket-home/assets"));
+#if JUCE_LINUX
+  // FIXME: don't hardcode this, maybe find it via .deb configuration
+  searchPath.add(File("/usr/share/pocket-home"));
+#endif
+  searchPath.add(absoluteFileFromPath("../../assets"));
+}
+
+Array<File> AssetResolver::getSearchPath() const {
+  return searchPath;
+}
+
+void AssetResolver::rescan() {
+  HashMap<String, File> newIndex;
+  Array<File> directories;
+
+  // walk from lowest to highest priority so overrides replace earlier entries
+  for (int i = searchPath.size(); --i >= 0;) {
+    const auto &root = searchPath.getReference(i);
+    directories.add(root);
+    if (!root.isDirectory()) continue;
+
+    Array<File> children;
+    root.findChildFiles(children, File::findFilesAndDirectories, true);
+    for (const auto &child : children) {
+      if (child.isDirectory()) {
+        directories.add(child);
+      } else {
+        newIndex.set(child.getRelativePathFrom(root), child);
+      }
+    }
+  }
+
+  {
+    const ScopedLock sl(lock);
+    index.swapWith(newIndex);
+    scanned = true;
+  }
+  setDirectories(directories);
+}
+
+File AssetResolver::resolve(const String &name) {
+  if (File::isAbsolutePath(name)) return absoluteFileFromPath(name);
+
+  bool needsScan;
+  {
+    const ScopedLock sl(lock);
+    needsScan = !scanned;
+  }
+  if (needsScan) rescan();
+
+  {
+    const ScopedLock sl(lock);
+    if (index.contains(name)) return index[name];
+  }
+
+  // not an asset we know about, keep the old behaviour of looking next to the CWD
+  return absoluteFileFromPath(name);
+}
+
+void AssetResolver::startWatching() {
+  DirectoryWatcher::startWatching();
+}
+
+void AssetResolver::stopWatching() {
+  DirectoryWatcher::stopWatching();
+}
+
+void AssetResolver::filesChanged(const Array<File> &changedFiles) {
+  // a missing root is watched through its parent, ignore unrelated files living there
+  bool relevant = false;
+  for (const auto &file : changedFiles) {
+    for (const auto &root : searchPath) {
+      relevant = relevant || file == root || file.isAChildOf(root);
+    }
+  }
+  if (!relevant) return;
+
+  DBG("AssetResolver: " << changedFiles.size() << " asset files changed, rescanning");
+  rescan();
+}
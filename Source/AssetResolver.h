@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DirectoryWatcher.h"
+
+// Resolves asset names like "backIcon.png" or "appIcons/terminal.png" against an ordered
+// overlay of asset directories:
+//   ~/.pocket-home/assets    user overrides and theme packs
+//   /usr/share/pocket-home   installed assets
+//   ../../assets             development builds
+// The directories are scanned once into a name -> file index, so lookups don't touch the
+// filesystem. The index is rebuilt when inotify reports a change in any of them, so assets
+// resolved from then on come from the new files. Images already decoded and on screen
+// are kept, a new theme fully applies on the next start.
+class AssetResolver : private DirectoryWatcher {
+public:
+  static AssetResolver &getInstance();
+
+  File resolve(const String &name);
+
+  void rescan();
+  void startWatching();
+  void stopWatching();
+
+  Array<File> getSearchPath() const;
+
+private:
+  AssetResolver();
+
+  void filesChanged(const Array<File> &changedFiles) override;
+
+  Array<File> searchPath;
+
+  CriticalSection lock;
+  HashMap<String, File> index;
+  bool scanned = false;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AssetResolver)
+};
@@ -0,0 +1,63 @@
+#include "AsyncInit.h"
+
+class AsyncInit::ReadyMessage : public CallbackMessage {
+public:
+  explicit ReadyMessage(std::function<void()> callback) : callback(std::move(callback)) {}
+
+  void messageCallback() override {
+    callback();
+  }
+
+private:
+  std::function<void()> callback;
+};
+
+AsyncInit &AsyncInit::getInstance() {
+  static AsyncInit instance;
+  return instance;
+}
+
+AsyncInit::AsyncInit() {}
+
+AsyncInit::~AsyncInit() {
+  waitForAll();
+}
+
+void AsyncInit::start(const char *name, std::function<void()> work,
+                      std::function<void()> onReady) {
+  const ScopedLock sl(lock);
+  if (stopping) return;
+
+  ++pending;
+  workers.emplace_back([this, name, work, onReady] {
+    Thread::setCurrentThreadName(name);
+    const double started = Time::getMillisecondCounterHiRes();
+    work();
+    DBG("AsyncInit: " << name << " ready after "
+        << roundToInt(Time::getMillisecondCounterHiRes() - started) << "ms");
+
+    const ScopedLock sl(lock);
+    if (!stopping) {
+      (new ReadyMessage([this, onReady] {
+        onReady();
+        --pending;
+      }))->post();
+    }
+  });
+}
+
+int AsyncInit::getNumPending() const {
+  return pending.get();
+}
+
+void AsyncInit::waitForAll() {
+  std::vector<std::thread> running;
+  {
+    const ScopedLock sl(lock);
+    stopping = true;
+    running.swap(workers);
+  }
+  for (auto &worker : running) {
+    if (worker.joinable()) worker.join();
+  }
+}
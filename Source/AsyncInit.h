@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Blocking startup work (opening the sound device, D-Bus round trips, helper processes)
+// runs here on worker threads instead of holding up the message thread:
+//
+//   AsyncInit::getInstance().run<bool>("sound", [] { return openSound(); },
+//                                      [](const bool &ok) { ... });
+//
+// The result lands in a future as soon as the work is done, and onReady gets it on the
+// message thread after that. Until then the UI shows the subsystem's state as unknown.
+class AsyncInit {
+public:
+  static AsyncInit &getInstance();
+
+  template <typename Result>
+  std::shared_future<Result> run(const char *name, std::function<Result()> work,
+                                 std::function<void(const Result &)> onReady = nullptr) {
+    auto promise = std::make_shared<std::promise<Result>>();
+    std::shared_future<Result> future = promise->get_future().share();
+    start(name, [promise, work] { promise->set_value(work()); },
+          [future, onReady] {
+            if (onReady) onReady(future.get());
+          });
+    return future;
+  }
+
+  // Tasks started whose onReady hasn't run yet.
+  int getNumPending() const;
+
+  // Joins the workers still running, for shutdown. Callbacks not delivered yet are dropped.
+  void waitForAll();
+
+private:
+  AsyncInit();
+  ~AsyncInit();
+
+  class ReadyMessage;
+  void start(const char *name, std::function<void()> work, std::function<void()> onReady);
+
+  CriticalSection lock;
+  std::vector<std::thread> workers;
+  bool stopping = false;
+  Atomic<int> pending;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AsyncInit)
+};
@@ -0,0 +1,68 @@
+#include "BackgroundSurface.h"
+#include "ImageScaling.h"
+#include "SharedImageCache.h"
+
+BackgroundSurface::BackgroundSurface(Component &owner, Colour colour, const File &imageFile)
+: owner(owner), colour(colour.withAlpha(1.0f)), imageFile(imageFile) {
+  owner.setOpaque(true);
+}
+
+void BackgroundSurface::setColour(Colour newColour) {
+  newColour = newColour.withAlpha(1.0f);
+  if (colour == newColour) return;
+  colour = newColour;
+  updateSurface();
+}
+
+void BackgroundSurface::setImageFile(const File &file) {
+  imageFile = file;
+  source = Image();
+  updateSurface();
+}
+
+void BackgroundSurface::setImage(const Image &image) {
+  imageFile = File();
+  source = image;
+  updateSurface();
+}
+
+void BackgroundSurface::resized() {
+  if (surface.isValid() && surface.getBounds() == owner.getLocalBounds()) return;
+  updateSurface();
+}
+
+void BackgroundSurface::updateSurface() {
+  const int width = owner.getWidth(), height = owner.getHeight();
+  surface = Image();
+  if (width > 0 && height > 0) {
+    if (source.isValid()) {
+      surface = downsampleImage(source, width, height);
+    } else if (imageFile != File()) {
+      surface = SharedImageCache::getInstance().getImage(imageFile, width, height);
+    }
+  }
+
+  // a null Image claims an alpha channel too, but with only the colour there's nothing to flatten
+  if (surface.isValid() && surface.hasAlphaChannel()) {
+    // flatten once here rather than blending on every paint
+    Image flattened(Image::RGB, width, height, false);
+    Graphics g(flattened);
+    g.fillAll(colour);
+    g.drawImageAt(surface, 0, 0);
+    surface = flattened;
+  }
+  // the surface for the old size, if it came from the cache
+  SharedImageCache::getInstance().releaseUnusedSoon();
+  owner.repaint();
+}
+
+void BackgroundSurface::paint(Graphics &g) const {
+  if (!surface.isValid()) {
+    g.fillAll(colour);
+    return;
+  }
+  // same size as the owner, so this is a plain copy of the clipped area
+  const auto clip = g.getClipBounds().getIntersection(surface.getBounds());
+  g.drawImage(surface, clip.getX(), clip.getY(), clip.getWidth(), clip.getHeight(), clip.getX(),
+              clip.getY(), clip.getWidth(), clip.getHeight());
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// A page's background, kept as one opaque image at exactly the page's size.
+// The image is scaled once per resized() instead of being resampled by drawImage() on every
+// repaint, so a repaint (a clock tick under a label, say) only copies the dirty pixels.
+// Opaque backgrounds come straight from SharedImageCache, which means every page drawing the
+// same file at the same size (settingsBackground.png) shares a single surface. Backgrounds
+// with transparency are flattened onto the fill colour once per size.
+// The owner is marked opaque, so JUCE doesn't repaint whatever is behind it either.
+class BackgroundSurface {
+public:
+  // The colour is used fully opaque, whatever its alpha.
+  BackgroundSurface(Component &owner, Colour colour, const File &imageFile = File());
+
+  void setColour(Colour colour);
+  // File() leaves just the colour
+  void setImageFile(const File &imageFile);
+  // For images decoded elsewhere (the launcher's wallpaper), anything not at the owner's size
+  // is scaled to it.
+  void setImage(const Image &image);
+
+  // Call from the owner's resized() and paint().
+  void resized();
+  void paint(Graphics &g) const;
+
+private:
+  void updateSurface();
+
+  Component &owner;
+  Colour colour;
+  File imageFile;
+  Image source;  // set through setImage(), otherwise decoded from imageFile
+  Image surface; // opaque and at the owner's size, or null when there's only the colour
+
+  JUCE_DECLARE_NON_COPYABLE(BackgroundSurface)
+};
@@ -0,0 +1,130 @@
+#include "BootSnapshot.h"
+#include "StartupBench.h"
+
+class BootSnapshot::WriteJob : public ThreadPoolJob {
+public:
+  WriteJob(const Image &image, const File &file)
+  : ThreadPoolJob("BootSnapshot write"), image(image), file(file) {}
+
+  JobStatus runJob() override {
+    write(image, file);
+    return jobHasFinished;
+  }
+
+private:
+  Image image;
+  File file;
+};
+
+BootSnapshot &BootSnapshot::getInstance() {
+  static BootSnapshot instance;
+  return instance;
+}
+
+BootSnapshot::BootSnapshot() : writer(1) {}
+
+File BootSnapshot::getFile(bool lockScreen) {
+  return File("~/.pocket-home/cache").getChildFile(lockScreen ? "boot-lock.jpg" : "boot-launcher.jpg");
+}
+
+void BootSnapshot::save(Component &component, bool lockScreen, bool inBackground) {
+  if (component.getWidth() <= 0 || component.getHeight() <= 0) return;
+  // rendering has to happen here on the message thread, only the encoding can move
+  auto image = component.createComponentSnapshot(component.getLocalBounds());
+  const auto file = getFile(lockScreen);
+
+  // an older snapshot still waiting to be written is out of date now
+  writer.removeAllJobs(false, 0);
+  if (inBackground) {
+    writer.addJob(new WriteJob(image, file), true);
+  } else {
+    writer.removeAllJobs(true, 2000);
+    write(image, file);
+  }
+}
+
+void BootSnapshot::write(const Image &image, const File &file) {
+  if (!file.getParentDirectory().createDirectory()) return;
+
+  // written next to the snapshot and renamed over it, a crash never leaves half a JPEG
+  TemporaryFile temp(file);
+  {
+    FileOutputStream out(temp.getFile());
+    if (out.failedToOpen()) return;
+    JPEGImageFormat jpeg;
+    jpeg.setQuality(0.85f);
+    if (!jpeg.writeImageToStream(image, out)) return;
+    out.flush();
+    if (out.getStatus().failed()) return;
+  }
+  temp.overwriteTargetFileWithTemporary();
+}
+
+class BootSnapshotComponent::FirstFrameMessage : public CallbackMessage {
+public:
+  explicit FirstFrameMessage(BootSnapshotComponent *component) : component(component) {}
+
+  void messageCallback() override {
+    if (component) component->firstFrameShown();
+  }
+
+private:
+  Component::SafePointer<BootSnapshotComponent> component;
+};
+
+BootSnapshotComponent *BootSnapshotComponent::create(bool lockScreen) {
+  const auto file = BootSnapshot::getFile(lockScreen);
+  if (!file.existsAsFile()) return nullptr;
+  auto image = ImageFileFormat::loadFrom(file);
+  if (!image.isValid()) return nullptr;
+  return new BootSnapshotComponent(image);
+}
+
+BootSnapshotComponent::BootSnapshotComponent(const Image &image) : image(image) {
+  setOpaque(true);
+  setSize(image.getWidth(), image.getHeight());
+  // in case the window is never painted (not mapped, no display), don't hold up startup
+  startTimer(1000);
+}
+
+void BootSnapshotComponent::paint(Graphics &g) {
+  g.drawImageAt(image, 0, 0);
+  StartupBench::getInstance().framePainted(false);
+  if (!firstFramePainted) {
+    firstFramePainted = true;
+    // the frame is blitted once paint returns, carry on from the message loop after that
+    (new FirstFrameMessage(this))->post();
+  }
+}
+
+void BootSnapshotComponent::firstFrameShown() {
+  if (firstFrameHandled) return;
+  firstFrameHandled = true;
+  if (!fading) stopTimer();
+  if (onFirstFrame) onFirstFrame();
+}
+
+void BootSnapshotComponent::fadeOut(int durationMillis) {
+  firstFrameHandled = true;
+  fading = true;
+  fadeMillis = jmax(1, durationMillis);
+  fadeStart = Time::getMillisecondCounterHiRes();
+  setOpaque(false);
+  startTimerHz(60);
+}
+
+void BootSnapshotComponent::timerCallback() {
+  if (!fading) {
+    firstFrameShown();
+    return;
+  }
+
+  const double progress = (Time::getMillisecondCounterHiRes() - fadeStart) / fadeMillis;
+  if (progress >= 1.0) {
+    stopTimer();
+    setVisible(false);
+    image = Image();
+    return;
+  }
+  setAlpha(float(1.0 - progress));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// The last frame of the launcher (or of the lock screen) from the previous session.
+// Pages take a while to construct on the CHIP, so at boot the snapshot is put on screen
+// first and the live UI cross-fades in over it once it exists.
+// Snapshots are JPEGs under ~/.pocket-home/cache, encoded and written on a background
+// thread so saving one doesn't stall the page transition that triggered it.
+class BootSnapshot {
+public:
+  static BootSnapshot &getInstance();
+
+  static File getFile(bool lockScreen);
+
+  // Renders the component at its current size and saves it as the next boot's first frame.
+  void save(Component &component, bool lockScreen, bool inBackground = true);
+
+private:
+  BootSnapshot();
+
+  class WriteJob;
+  static void write(const Image &image, const File &file);
+
+  ThreadPool writer;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BootSnapshot)
+};
+
+// Shows a saved snapshot until the real content is ready, then fades it out.
+class BootSnapshotComponent : public Component, private Timer {
+public:
+  // nullptr when no snapshot has been saved for this screen yet
+  static BootSnapshotComponent *create(bool lockScreen);
+
+  // Called (asynchronously) once the snapshot has made it to the screen, or after a second
+  // if the window never gets painted. Startup continues from here.
+  std::function<void()> onFirstFrame;
+
+  // Fades to transparent and then hides, dropping the image.
+  void fadeOut(int durationMillis);
+
+  void paint(Graphics &g) override;
+
+private:
+  explicit BootSnapshotComponent(const Image &image);
+
+  class FirstFrameMessage;
+  void firstFrameShown();
+  void timerCallback() override;
+
+  Image image;
+  bool firstFramePainted = false;
+  bool firstFrameHandled = false;
+  bool fading = false;
+  double fadeStart = 0;
+  int fadeMillis = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BootSnapshotComponent)
+};
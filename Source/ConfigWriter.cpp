@@ -0,0 +1,156 @@
+#include "ConfigWriter.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+bool writeAll(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    const auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= (size_t)written;
+  }
+  return true;
+}
+
+// So the rename itself survives a power cut.
+void syncDirectory(const File &directory) {
+  const int fd = ::open(directory.getFullPathName().toRawUTF8(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) return;
+  ::fsync(fd);
+  ::close(fd);
+}
+
+}
+
+class ConfigWriter::WrittenMessage : public CallbackMessage {
+public:
+  WrittenMessage(ConfigWriter &writer, bool ok) : writer(writer), alive(writer.alive), ok(ok) {}
+
+  void messageCallback() override {
+    if (alive->alive && writer.written) writer.written(ok);
+  }
+
+private:
+  ConfigWriter &writer;
+  ReferenceCountedObjectPtr<Alive> alive;
+  bool ok;
+};
+
+ConfigWriter::ConfigWriter(std::function<String()> serialize, int coalesceMs)
+: Thread("ConfigWriter"), serialize(serialize), coalesceMs(coalesceMs), alive(new Alive()) {}
+
+ConfigWriter::~ConfigWriter() {
+  alive->alive = false;
+  stopTimer();
+  stopThread(5000);
+}
+
+void ConfigWriter::setWriteCallback(std::function<void(bool ok)> callback) {
+  written = callback;
+}
+
+bool ConfigWriter::writeAtomically(const File &file, const String &text) {
+  const auto directory = file.getParentDirectory();
+  if (!directory.createDirectory()) return false;
+
+  // same directory, rename() has to stay on one filesystem
+  const auto temp = directory.getNonexistentChildFile("." + file.getFileName(), ".tmp", false);
+  const auto tempPath = temp.getFullPathName();
+  const int fd = ::open(tempPath.toRawUTF8(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) return false;
+
+  const bool ok = writeAll(fd, text.toRawUTF8(), text.getNumBytesAsUTF8()) && ::fsync(fd) == 0;
+  if (::close(fd) != 0 || !ok ||
+      ::rename(tempPath.toRawUTF8(), file.getFullPathName().toRawUTF8()) != 0) {
+    ::unlink(tempPath.toRawUTF8());
+    return false;
+  }
+  syncDirectory(directory);
+  return true;
+}
+
+void ConfigWriter::schedule(const File &file) {
+  dirtyFile = file;
+  // a fixed window from the first change, not restarted by later ones, so a steady stream
+  // of edits still gets written out every coalesceMs
+  if (!isTimerRunning()) startTimer(coalesceMs);
+}
+
+void ConfigWriter::takePending() {
+  stopTimer();
+  if (dirtyFile == File::nonexistent) return;
+
+  auto text = serialize();
+  const ScopedLock sl(lock);
+  pendingFile = dirtyFile;
+  pendingText = text;
+  hasPending = true;
+  dirtyFile = File::nonexistent;
+}
+
+void ConfigWriter::timerCallback() {
+  takePending();
+  if (isThreadRunning()) {
+    notify();
+  } else {
+    startThread(3);
+  }
+}
+
+bool ConfigWriter::writePending() {
+  const ScopedLock wl(writeLock);
+  File file;
+  String text;
+  {
+    const ScopedLock sl(lock);
+    if (!hasPending) return lastWriteOk;
+    file = pendingFile;
+    text = pendingText;
+    hasPending = false;
+    pendingText = String::empty;
+    writing = true;
+  }
+
+  const bool ok = writeAtomically(file, text);
+  if (!ok) DBG("ConfigWriter: couldn't write " << file.getFullPathName());
+  const ScopedLock sl(lock);
+  lastWriteOk = ok;
+  writing = false;
+  return ok;
+}
+
+bool ConfigWriter::flush() {
+  takePending();
+  // also waits, on writeLock, for a write the thread has already started
+  return writePending();
+}
+
+bool ConfigWriter::hasUnwrittenChanges() const {
+  if (dirtyFile != File::nonexistent) return true;
+  const ScopedLock sl(lock);
+  return hasPending || writing;
+}
+
+void ConfigWriter::run() {
+  while (!threadShouldExit()) {
+    bool pending;
+    {
+      const ScopedLock sl(lock);
+      pending = hasPending;
+    }
+    if (pending) {
+      (new WrittenMessage(*this, writePending()))->post();
+    } else {
+      wait(-1);
+    }
+  }
+  // anything handed over but not written yet
+  writePending();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#include <functional>
+
+// Writes a config file on its own thread instead of the message thread.
+// schedule() only marks the file dirty: changes arriving within the coalescing window are
+// serialized once when it closes and written in one go, so reordering five icons is one
+// write rather than five. Writes go to a temporary file next to the target that is
+// fsync'ed and renamed over it, a crash or power cut leaves either the old or the new file.
+class ConfigWriter : private Thread, private Timer {
+public:
+  // serialize is called on the message thread, whenever a write is due.
+  ConfigWriter(std::function<String()> serialize, int coalesceMs = 500);
+  ~ConfigWriter();
+
+  // Message thread only.
+  void schedule(const File &file);
+  // Writes any pending change now and waits for a write already in progress.
+  // Returns false if the last write failed. Message thread only.
+  bool flush();
+  // Whether something scheduled hasn't made it to the file yet.
+  bool hasUnwrittenChanges() const;
+  // Called on the message thread after each write the background thread makes, with whether
+  // it succeeded. Not for flush(), which returns that itself.
+  void setWriteCallback(std::function<void(bool ok)> callback);
+
+  // The temp file, fsync and rename dance, synchronously. Returns false on any error,
+  // leaving the target as it was.
+  static bool writeAtomically(const File &file, const String &text);
+
+private:
+  class WrittenMessage;
+
+  void timerCallback() override;
+  void run() override;
+  void takePending();
+  bool writePending();
+
+  std::function<String()> serialize;
+  std::function<void(bool ok)> written;
+  const int coalesceMs;
+  File dirtyFile;
+
+  // the serialized text waiting for the writer thread
+  CriticalSection lock;
+  File pendingFile;
+  String pendingText;
+  bool hasPending = false;
+  bool writing = false;
+  bool lastWriteOk = true;
+
+  // held for the duration of a write, so flush() can't overtake the thread with older text
+  CriticalSection writeLock;
+
+  // shared with pending WrittenMessages, so they can tell the writer is gone
+  struct Alive : public ReferenceCountedObject {
+    bool alive = true;
+  };
+  ReferenceCountedObjectPtr<Alive> alive;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConfigWriter)
+};
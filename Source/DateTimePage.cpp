@@ -21,8 +21,7 @@ lc(lc)
   choosemode.addListener(this);
   
   //Let's check whether there is an option for time format in the config
-  var json = getConfigJSON();
-  if(json["timeformat"].toString() == "ampm")
+  if(AppConfig::getInstance().getTimeFormat() == "ampm")
     choosemode.setSelectedId(2);
   else choosemode.setSelectedId(1);
   
@@ -49,14 +48,11 @@ void DateTimePage::buttonClicked(Button* but){
 
 void DateTimePage::comboBoxChanged(ComboBox* c){
   if(c != &choosemode) return;
-  var json = getConfigJSON();
-  DynamicObject* hour = json.getDynamicObject();
+  auto &config = AppConfig::getInstance();
   String format = (c->getSelectedId()==1)?"24h":"ampm";
-  hour->setProperty("timeformat", format);
-  //JSON config has been changed, let's write it to the file
-  File configfile = getConfigFile();
-  String jsonstring = JSON::toString(json);
-  configfile.replaceWithText(jsonstring);
+  config.setTimeFormat(format);
+  //Config has been changed, let's write it to the file
+  config.save();
   
   lc->setClockAMPM(format=="ampm");
 }
@@ -4,6 +4,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Utils.h"
 #include "Main.h"
+#include "AppConfigModel.h"
 
 using namespace juce;
 
@@ -0,0 +1,123 @@
+#include "DirectoryWatcher.h"
+
+#if JUCE_LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+DirectoryWatcher::DirectoryWatcher(const String &threadName) : Thread(threadName) {}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  stopWatching();
+}
+
+void DirectoryWatcher::setDirectories(const Array<File> &newDirectories) {
+  const ScopedLock sl(lock);
+  directories = newDirectories;
+  directoriesChanged = true;
+}
+
+void DirectoryWatcher::startWatching() {
+#if JUCE_LINUX
+  if (isThreadRunning()) return;
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd < 0) {
+    DBG("DirectoryWatcher: inotify unavailable, " << getThreadName() << " won't refresh");
+    return;
+  }
+  startThread(1);
+#endif
+}
+
+void DirectoryWatcher::stopWatching() {
+  stopThread(1000);
+#if JUCE_LINUX
+  if (inotifyFd >= 0) {
+    close(inotifyFd);
+    inotifyFd = -1;
+  }
+#endif
+  watchedPaths.clear();
+}
+
+void DirectoryWatcher::addWatches() {
+#if JUCE_LINUX
+  Array<File> toWatch;
+  {
+    const ScopedLock sl(lock);
+    toWatch = directories;
+    directoriesChanged = false;
+  }
+
+  const uint32_t mask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+                        IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+  for (auto dir : toWatch) {
+    // a missing directory is picked up by watching the closest parent that exists
+    while (!dir.isDirectory() && dir.getParentDirectory() != dir) {
+      dir = dir.getParentDirectory();
+    }
+    int wd = inotify_add_watch(inotifyFd, dir.getFullPathName().toRawUTF8(), mask);
+    if (wd >= 0) watchedPaths.set(wd, dir.getFullPathName());
+  }
+#endif
+}
+
+void DirectoryWatcher::removeWatches() {
+#if JUCE_LINUX
+  for (HashMap<int, String>::Iterator i(watchedPaths); i.next();) {
+    inotify_rm_watch(inotifyFd, i.getKey());
+  }
+#endif
+  watchedPaths.clear();
+}
+
+void DirectoryWatcher::run() {
+#if JUCE_LINUX
+  addWatches();
+
+  alignas(struct inotify_event) char buffer[4096];
+  while (!threadShouldExit()) {
+    bool rewatch;
+    {
+      const ScopedLock sl(lock);
+      rewatch = directoriesChanged;
+    }
+
+    struct pollfd pfd = { inotifyFd, POLLIN, 0 };
+    if (poll(&pfd, 1, rewatch ? 0 : 500) > 0) {
+      // keep reading until things have been quiet for a moment
+      Array<File> changedFiles;
+      do {
+        ssize_t len = read(inotifyFd, buffer, sizeof(buffer));
+        for (char *p = buffer; p < buffer + len;) {
+          auto event = reinterpret_cast<struct inotify_event *>(p);
+          p += sizeof(struct inotify_event) + event->len;
+
+          // IN_IGNORED follows every watch removal, including our own
+          if (event->mask & IN_IGNORED) continue;
+          if (event->mask & (IN_CREATE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)) {
+            rewatch = true;
+          }
+
+          const String dir = watchedPaths[event->wd];
+          if (dir.isEmpty()) continue;
+          File changed = event->len ? File(dir).getChildFile(String::fromUTF8(event->name))
+                                    : File(dir);
+          changedFiles.addIfNotAlreadyThere(changed);
+        }
+      } while (!threadShouldExit() && poll(&pfd, 1, 100) > 0);
+
+      if (changedFiles.size()) filesChanged(changedFiles);
+    }
+
+    // directories may have appeared or vanished, point the watches at the current tree
+    if (rewatch) {
+      removeWatches();
+      addWatches();
+    }
+  }
+
+  removeWatches();
+#endif
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Watches a set of directories with inotify on a background thread.
+// filesChanged() is called on the watcher thread whenever files in the watched directories
+// are created, removed, renamed or finished being written. Bursts of events (a theme being
+// unpacked, an editor's save dance) are collected into one call.
+// Directories that don't exist yet can be watched too, their parent is watched instead
+// and the watch is moved over once they appear.
+class DirectoryWatcher : private Thread {
+public:
+  DirectoryWatcher(const String &threadName);
+  virtual ~DirectoryWatcher();
+
+  // Replaces the watched set, safe to call from any thread.
+  void setDirectories(const Array<File> &directories);
+
+  void startWatching();
+  void stopWatching();
+
+protected:
+  virtual void filesChanged(const Array<File> &changedFiles) = 0;
+
+private:
+  void run() override;
+  void addWatches();
+  void removeWatches();
+
+  CriticalSection lock;
+  Array<File> directories;
+  bool directoriesChanged = false;
+
+  int inotifyFd = -1;
+  HashMap<int, String> watchedPaths;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DirectoryWatcher)
+};
@@ -0,0 +1,342 @@
+#include "DiskImageCache.h"
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char blobMagic[4] = { 'P', 'H', 'P', 'X' };
+// 2: the source path follows the header
+const uint32 blobVersion = 2;
+// longer paths than this are taken for a corrupt blob
+const int32 maxPathBytes = 4096;
+
+enum BlobFormat { blobRGB = 1, blobARGB = 2 };
+
+// Fixed 64 byte header, then the source's full path in UTF-8 (the file name is only a hash
+// of it), then zeroes up to the next 16 bytes so the pixel rows stay aligned in the mapping.
+struct BlobHeader {
+  char magic[4];
+  uint32 version;
+  int64 sourceModified;
+  int64 sourceSize;
+  int32 width;
+  int32 height;
+  int32 format;
+  int32 lineStride;
+  int32 pathBytes;
+  char padding[20];
+};
+
+static_assert(sizeof(BlobHeader) == 64, "blob header must stay 64 bytes");
+
+size_t getDataOffset(const BlobHeader &header) {
+  return (sizeof(BlobHeader) + (size_t)header.pathBytes + 15) & ~(size_t)15;
+}
+
+#if JUCE_LINUX
+// Image data living in a private (copy-on-write) mapping of a cache blob. Drawing into
+// the image only dirties our own pages, the blob on disk is never modified.
+class MappedImagePixelData : public ImagePixelData {
+public:
+  MappedImagePixelData(Image::PixelFormat format, int w, int h, void *mapping, size_t mappingSize,
+                       size_t dataOffset, int lineStride)
+  : ImagePixelData(format, w, h),
+    mapping(mapping),
+    mappingSize(mappingSize),
+    imageData(static_cast<uint8 *>(mapping) + dataOffset),
+    pixelStride(format == Image::RGB ? 3 : 4),
+    lineStride(lineStride) {}
+
+  ~MappedImagePixelData() {
+    munmap(mapping, mappingSize);
+  }
+
+  LowLevelGraphicsContext *createLowLevelContext() override {
+    return new LowLevelGraphicsSoftwareRenderer(Image(this));
+  }
+
+  void initialiseBitmapData(Image::BitmapData &bitmap, int x, int y,
+                            Image::BitmapData::ReadWriteMode) override {
+    bitmap.data = imageData + x * pixelStride + y * lineStride;
+    bitmap.pixelFormat = pixelFormat;
+    bitmap.lineStride = lineStride;
+    bitmap.pixelStride = pixelStride;
+  }
+
+  ImagePixelData::Ptr clone() override {
+    Image copy(pixelFormat, width, height, false);
+    Image::BitmapData dest(copy, Image::BitmapData::writeOnly);
+    for (int y = 0; y < height; ++y) {
+      memcpy(dest.getLinePointer(y), imageData + y * lineStride, (size_t)width * pixelStride);
+    }
+    return copy.getPixelData();
+  }
+
+  ImageType *createType() const override {
+    return new SoftwareImageType();
+  }
+
+private:
+  void *mapping;
+  size_t mappingSize;
+  uint8 *imageData;
+  const int pixelStride, lineStride;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedImagePixelData)
+};
+#endif
+
+// storedPath guards against two sources whose paths hash the same sharing a blob name
+bool headerMatches(const BlobHeader &header, const String &storedPath, const File &source,
+                   int width, int height, bool fitted) {
+  const bool sizeMatches = fitted ? header.width <= width && header.height <= height
+                                  : (width <= 0 || header.width == width) &&
+                                        (height <= 0 || header.height == height);
+  return memcmp(header.magic, blobMagic, sizeof(blobMagic)) == 0 &&
+         header.version == blobVersion && storedPath == source.getFullPathName() &&
+         header.sourceModified == source.getLastModificationTime().toMilliseconds() &&
+         header.sourceSize == source.getSize() && sizeMatches &&
+         (header.format == blobRGB || header.format == blobARGB);
+}
+
+} // namespace
+
+DiskImageCache &DiskImageCache::getInstance() {
+  static DiskImageCache instance;
+  return instance;
+}
+
+DiskImageCache::DiskImageCache()
+: Thread("DiskImageCache"), cacheDirectory("~/.pocket-home/cache/pixels") {}
+
+DiskImageCache::~DiskImageCache() {
+  shutdown();
+}
+
+void DiskImageCache::setEnabled(bool shouldBeEnabled) {
+  enabled = shouldBeEnabled;
+}
+
+bool DiskImageCache::isEnabled() const {
+  return enabled;
+}
+
+File DiskImageCache::getCacheDirectory() const {
+  return cacheDirectory;
+}
+
+void DiskImageCache::setMaxBytes(int64 newMaxBytes) {
+  maxBytes = newMaxBytes;
+}
+
+void DiskImageCache::prune() {
+  struct Blob {
+    File file;
+    int64 size;
+    int64 lastUsed;
+  };
+  Array<Blob> blobs;
+  int64 total = 0;
+  DirectoryIterator it(cacheDirectory, false, "*.px", File::findFiles);
+  while (it.next()) {
+    const auto file = it.getFile();
+    struct stat st;
+    if (stat(file.getFullPathName().toRawUTF8(), &st) != 0) continue;
+    // relatime only bumps atime about once a day (or when older than the mtime), which is
+    // fine grained enough for telling stale blobs from ones in use
+    const Blob blob = { file, (int64)st.st_size, (int64)jmax(st.st_atime, st.st_mtime) };
+    blobs.add(blob);
+    total += st.st_size;
+  }
+
+  const int64 budget = maxBytes;
+  if (total > budget) {
+    std::sort(blobs.begin(), blobs.end(),
+              [](const Blob &a, const Blob &b) { return a.lastUsed < b.lastUsed; });
+    int removed = 0;
+    for (const auto &blob : blobs) {
+      if (total <= budget) break;
+      if (!blob.file.deleteFile()) continue;
+      total -= blob.size;
+      removed++;
+    }
+    DBG("DiskImageCache: pruned " << removed << " blobs, " << (total / 1024) << " KiB left");
+  }
+  cachedBytes = total;
+}
+
+void DiskImageCache::pruneSoon() {
+  pruneRequested = true;
+  wake();
+}
+
+void DiskImageCache::wake() {
+  if (shuttingDown) return;
+  if (!isThreadRunning()) startThread(1);
+  notify();
+}
+
+void DiskImageCache::shutdown() {
+  shuttingDown = true;
+  signalThreadShouldExit();
+  notify();
+  stopThread(2000);
+  const ScopedLock lock(pendingLock);
+  pendingStores.clear();
+}
+
+void DiskImageCache::run() {
+  while (!threadShouldExit()) {
+    wait(-1);
+    while (!threadShouldExit()) {
+      PendingStore pending;
+      {
+        const ScopedLock lock(pendingLock);
+        if (pendingStores.isEmpty()) break;
+        pending = pendingStores.removeAndReturn(0);
+      }
+      writeBlob(pending);
+    }
+    if (threadShouldExit()) break;
+    if (pruneRequested.exchange(false)) prune();
+  }
+}
+
+File DiskImageCache::getBlobFile(const File &source, int width, int height, bool fitted) const {
+  auto name = String::toHexString(source.getFullPathName().hashCode64()) + "-" + String(width) +
+              "x" + String(height) + (fitted ? "-fit.px" : ".px");
+  return cacheDirectory.getChildFile(name);
+}
+
+Image DiskImageCache::load(const File &source, int width, int height, bool fitted) {
+  if (!enabled) return Image();
+
+  auto blobFile = getBlobFile(source, width, height, fitted);
+  int fd = open(blobFile.getFullPathName().toRawUTF8(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return Image();
+
+  BlobHeader header;
+  struct stat st;
+  bool valid = read(fd, &header, sizeof(header)) == sizeof(header) && fstat(fd, &st) == 0 &&
+               header.pathBytes > 0 && header.pathBytes <= maxPathBytes;
+  if (valid) {
+    HeapBlock<char> path(header.pathBytes);
+    valid = read(fd, path, (size_t)header.pathBytes) == (ssize_t)header.pathBytes &&
+            headerMatches(header, String::fromUTF8(path, header.pathBytes), source, width,
+                          height, fitted);
+  }
+  const size_t dataOffset = valid ? getDataOffset(header) : 0;
+  const size_t dataSize = valid ? (size_t)header.lineStride * header.height : 0;
+  valid = valid && header.width > 0 && header.height > 0 &&
+          (size_t)st.st_size >= dataOffset + dataSize;
+
+  if (!valid) {
+    // the source changed, the blob is from an older build or another path hashed to the
+    // same name; drop it
+    close(fd);
+    blobFile.deleteFile();
+    return Image();
+  }
+
+  const auto format = header.format == blobARGB ? Image::ARGB : Image::RGB;
+
+#if JUCE_LINUX
+  const size_t mappingSize = dataOffset + dataSize;
+  void *mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return Image();
+  return Image(new MappedImagePixelData(format, header.width, header.height, mapping, mappingSize,
+                                        dataOffset, header.lineStride));
+#else
+  const int pixelStride = format == Image::ARGB ? 4 : 3;
+  if (lseek(fd, (off_t)dataOffset, SEEK_SET) != (off_t)dataOffset) {
+    close(fd);
+    return Image();
+  }
+  Image image(format, header.width, header.height, false);
+  Image::BitmapData dest(image, Image::BitmapData::writeOnly);
+  HeapBlock<uint8> row(header.lineStride);
+  for (int y = 0; y < header.height; ++y) {
+    if (read(fd, row, header.lineStride) != header.lineStride) {
+      close(fd);
+      return Image();
+    }
+    memcpy(dest.getLinePointer(y), row, (size_t)header.width * pixelStride);
+  }
+  close(fd);
+  return image;
+#endif
+}
+
+void DiskImageCache::store(const File &source, int width, int height, bool fitted,
+                           const Image &image) {
+  if (!enabled || shuttingDown || !image.isValid() || !(image.isARGB() || image.isRGB())) return;
+
+  // the blob describes the source as it was when the pixels were decoded, not when written
+  PendingStore pending;
+  pending.source = source;
+  pending.sourceModified = source.getLastModificationTime().toMilliseconds();
+  pending.sourceSize = source.getSize();
+  pending.width = width;
+  pending.height = height;
+  pending.fitted = fitted;
+  pending.image = image;
+  {
+    const ScopedLock lock(pendingLock);
+    if (pendingStores.size() >= maxPendingStores) return;
+    pendingStores.add(pending);
+  }
+  wake();
+}
+
+void DiskImageCache::writeBlob(const PendingStore &pending) {
+  const auto &image = pending.image;
+  if (!cacheDirectory.isDirectory() && !cacheDirectory.createDirectory()) return;
+
+  const auto path = pending.source.getFullPathName().toUTF8();
+  const auto pathBytes = (int32)path.sizeInBytes() - 1;
+  if (pathBytes <= 0 || pathBytes > maxPathBytes) return;
+
+  BlobHeader header;
+  zerostruct(header);
+  memcpy(header.magic, blobMagic, sizeof(blobMagic));
+  header.version = blobVersion;
+  header.sourceModified = pending.sourceModified;
+  header.sourceSize = pending.sourceSize;
+  header.pathBytes = pathBytes;
+  header.width = image.getWidth();
+  header.height = image.getHeight();
+  header.format = image.isARGB() ? blobARGB : blobRGB;
+
+  const int pixelStride = image.isARGB() ? 4 : 3;
+  const int rowBytes = header.width * pixelStride;
+  header.lineStride = (rowBytes + 3) & ~3;
+
+  // write next to the blob and rename over it, so a reader never maps half a file
+  const size_t dataOffset = getDataOffset(header);
+  TemporaryFile temp(getBlobFile(pending.source, pending.width, pending.height, pending.fitted));
+  {
+    FileOutputStream out(temp.getFile());
+    if (out.failedToOpen()) return;
+    out.write(&header, sizeof(header));
+    out.write(path.getAddress(), (size_t)pathBytes);
+    out.writeRepeatedByte(0, dataOffset - sizeof(header) - (size_t)pathBytes);
+
+    const Image::BitmapData src(image, Image::BitmapData::readOnly);
+    HeapBlock<uint8> row(header.lineStride, true);
+    for (int y = 0; y < header.height; ++y) {
+      memcpy(row, src.getLinePointer(y), (size_t)rowBytes);
+      out.write(row, (size_t)header.lineStride);
+    }
+    out.flush();
+    if (out.getStatus().failed()) return;
+  }
+  if (!temp.overwriteTargetFileWithTemporary()) return;
+
+  const int64 written = (int64)dataOffset + (int64)header.lineStride * header.height;
+  if (cachedBytes.load() >= 0 && (cachedBytes += written) > maxBytes) pruneRequested = true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#include <atomic>
+
+// On-disk cache of decoded pixels under ~/.pocket-home/cache/pixels.
+// Each blob holds the raw premultiplied ARGB (or RGB) rows exactly as JUCE keeps them in
+// memory, so on the next boot an image can be mapped straight into an Image without
+// touching zlib. Blobs are keyed by source path and target size and remember the source's
+// mtime and length; a blob whose source has changed is deleted the first time it's read.
+// Blobs are written on the cache's own thread, so decoding never waits on the SD card.
+// Blobs nobody asks for again (old wallpapers, icon sizes no longer used) are pruned least
+// recently used first once the directory grows past its budget, on a background thread.
+class DiskImageCache : private Thread {
+public:
+  static DiskImageCache &getInstance();
+
+  // Returns a null Image when there is no up-to-date blob for this file and size.
+  // Fitted blobs were scaled to fit within width x height rather than to exactly that size.
+  Image load(const File &source, int width, int height, bool fitted = false);
+  // Queues the image to be written out on the cache's thread and returns right away. The
+  // image must not be drawn into afterwards. Any thread.
+  void store(const File &source, int width, int height, bool fitted, const Image &image);
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+
+  File getCacheDirectory() const;
+
+  // how much the blobs may take up on disk in all
+  static const int64 defaultMaxBytes = 16 * 1024 * 1024;
+  void setMaxBytes(int64 maxBytes);
+
+  // Deletes the least recently used blobs until they fit the budget. Blocking.
+  void prune();
+  // prune() on the cache's own thread. Any thread.
+  void pruneSoon();
+  // Stops the cache's thread for good, for shutdown. Blobs still queued aren't written.
+  void shutdown();
+
+private:
+  struct PendingStore {
+    File source;
+    int64 sourceModified, sourceSize;
+    int width, height;
+    bool fitted;
+    Image image;
+  };
+
+  // stores past this many are dropped rather than holding on to more decoded pixels
+  static const int maxPendingStores = 32;
+
+  DiskImageCache();
+  ~DiskImageCache();
+
+  File getBlobFile(const File &source, int width, int height, bool fitted) const;
+  void writeBlob(const PendingStore &pending);
+  void wake();
+  void run() override;
+
+  File cacheDirectory;
+  std::atomic<bool> enabled{ true };
+  std::atomic<int64> maxBytes{ defaultMaxBytes };
+  // what the blobs took up as of the last prune() plus what's been stored since, -1 if unknown
+  std::atomic<int64> cachedBytes{ -1 };
+  std::atomic<bool> shuttingDown{ false };
+  std::atomic<bool> pruneRequested{ false };
+
+  CriticalSection pendingLock;
+  Array<PendingStore> pendingStores;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DiskImageCache)
+};
@@ -184,6 +184,22 @@ void Grid::removeItem(Component* item){
   showCurrentPage();
 }
 
+void Grid::setItems(const Array<Component *> &newItems) {
+  const int pageIndex = pages.indexOf(page);
+  selection->setVisible(false);
+  selectindex = 0;
+
+  // deleting the pages takes the items off their rows
+  page = nullptr;
+  pages.clear();
+  items.clear();
+  createPage();
+  page = pages.getFirst();
+  for (auto item : newItems) addItem(item);
+
+  showPageAtIndex(jlimit(0, pages.size() - 1, pageIndex));
+}
+
 /* Function used to shift the icons from one page to another
  * After deleting an icon 
  */
@@ -37,6 +37,9 @@ public:
   void createPage();
   void addItem(Component *item);
   void removeItem(Component*);
+  // Lays the grid out again with these items, in this order, staying on the same page
+  // if there still is one. Items not in the list are taken off the grid, not deleted.
+  void setItems(const Array<Component *> &newItems);
   bool hasPrevPage();
   bool hasNextPage();
   void showPageAtIndex(int idx);
@@ -0,0 +1,120 @@
+#include "IconLoader.h"
+#include "Utils.h"
+
+// Jobs don't carry a request of their own, each one decodes whatever is most urgent by
+// the time a pool thread gets to it. That way page flips re-prioritize queued work.
+class IconLoader::DecodeJob : public ThreadPoolJob {
+public:
+  DecodeJob(IconLoader &loader) : ThreadPoolJob("IconDecode"), loader(loader) {}
+
+  JobStatus runJob() override {
+    Request request;
+    if (loader.popRequest(request)) {
+      auto image = createImageToFit(request.file, request.width, request.height);
+      (new DeliveryMessage(loader, request, image))->post();
+    }
+    return jobHasFinished;
+  }
+
+private:
+  IconLoader &loader;
+};
+
+class IconLoader::DeliveryMessage : public CallbackMessage {
+public:
+  DeliveryMessage(IconLoader &loader, const Request &request, const Image &image)
+  : loader(loader), request(request), image(image) {}
+
+  void messageCallback() override {
+    loader.deliver(request, image);
+  }
+
+private:
+  IconLoader &loader;
+  Request request;
+  Image image;
+};
+
+IconLoader &IconLoader::getInstance() {
+  static IconLoader instance;
+  return instance;
+}
+
+IconLoader::IconLoader() : pool(jmax(1, SystemStats::getNumCpus())) {}
+
+Image IconLoader::getPlaceholder(int width, int height) {
+  static HashMap<int64, Image> placeholders;
+  const int64 key = ((int64)width << 32) | (uint32)height;
+  if (!placeholders.contains(key)) {
+    Image image(Image::ARGB, jmax(1, width), jmax(1, height), true);
+    Graphics g(image);
+    const auto size = (float)jmin(width, height) * 0.8f;
+    const auto centre = image.getBounds().getCentre().toFloat();
+    g.setColour(Colours::white.withAlpha(0.15f));
+    g.fillRoundedRectangle(Rectangle<float>(size, size).withCentre(centre), size * 0.15f);
+    placeholders.set(key, image);
+  }
+  return placeholders[key];
+}
+
+void IconLoader::requestIcon(Listener *listener, const File &file, int width, int height,
+                             bool visible) {
+  {
+    const ScopedLock sl(lock);
+    listeners.addIfNotAlreadyThere(listener);
+    for (int i = queue.size(); --i >= 0;) {
+      if (queue.getReference(i).listener == listener) queue.remove(i);
+    }
+    queue.add({ listener, file, width, height, visible });
+  }
+  pool.addJob(new DecodeJob(*this), true);
+}
+
+void IconLoader::setVisible(Listener *listener, bool visible) {
+  const ScopedLock sl(lock);
+  for (auto &request : queue) {
+    if (request.listener == listener) request.visible = visible;
+  }
+}
+
+void IconLoader::cancelRequests(Listener *listener) {
+  const ScopedLock sl(lock);
+  listeners.removeFirstMatchingValue(listener);
+  for (int i = queue.size(); --i >= 0;) {
+    if (queue.getReference(i).listener == listener) queue.remove(i);
+  }
+}
+
+bool IconLoader::popRequest(Request &request) {
+  const ScopedLock sl(lock);
+  if (queue.isEmpty()) return false;
+
+  // oldest visible request first, then oldest of the rest
+  int next = 0;
+  for (int i = 0; i < queue.size(); ++i) {
+    if (queue.getReference(i).visible) {
+      next = i;
+      break;
+    }
+  }
+  request = queue.removeAndReturn(next);
+  return true;
+}
+
+void IconLoader::deliver(const Request &request, const Image &image) {
+  {
+    // the listener may have been deleted while the icon was decoding
+    const ScopedLock sl(lock);
+    if (!listeners.contains(request.listener)) return;
+  }
+  request.listener->iconLoaded(request.file, request.width, request.height, image);
+}
+
+void IconLoader::shutdown() {
+  {
+    const ScopedLock sl(lock);
+    queue.clear();
+    listeners.clear();
+  }
+  pool.removeAllJobs(true, 2000);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Decodes app icons on a background ThreadPool so building or editing the app grid never
+// waits on image decoding. Requesters get a shared placeholder to show in the meantime and
+// are called back on the message thread once the real icon is ready.
+// Requests for icons on the visible grid page are decoded before everything else.
+class IconLoader {
+public:
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    // Called on the message thread. image is null if the file couldn't be decoded.
+    virtual void iconLoaded(const File &file, int width, int height, const Image &image) = 0;
+  };
+
+  static IconLoader &getInstance();
+
+  // Light placeholder of the given size, one shared Image per size.
+  static Image getPlaceholder(int width, int height);
+
+  // Replaces any request the listener still has queued.
+  void requestIcon(Listener *listener, const File &file, int width, int height, bool visible);
+  void setVisible(Listener *listener, bool visible);
+  // Must be called before a listener is deleted.
+  void cancelRequests(Listener *listener);
+
+  void shutdown();
+
+private:
+  IconLoader();
+
+  struct Request {
+    Listener *listener;
+    File file;
+    int width, height;
+    bool visible;
+  };
+
+  class DecodeJob;
+  class DeliveryMessage;
+
+  bool popRequest(Request &request);
+  void deliver(const Request &request, const Image &image);
+
+  ThreadPool pool;
+  CriticalSection lock;
+  Array<Request> queue;
+  Array<Listener *> listeners;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IconLoader)
+};
@@ -0,0 +1,68 @@
+// Checks that SharedImageCache shares decoded images while they're in use and lets go of
+// them once their last owner outside the cache is gone.
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DiskImageCache.h"
+#include "SharedImageCache.h"
+
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char *what) {
+  if (condition) return;
+  std::cerr << "FAILED! " << what << std::endl;
+  failures++;
+}
+
+File writePng(const File &directory, const String &name) {
+  Image image(Image::ARGB, 32, 32, true);
+  {
+    Graphics g(image);
+    g.fillAll(Colours::red);
+  }
+  auto file = directory.getChildFile(name);
+  FileOutputStream out(file);
+  PNGImageFormat().writeImageToStream(image, out);
+  return file;
+}
+
+}
+
+int main() {
+  ScopedJuceInitialiser_GUI juce;
+  // only what's held in memory is under test, keep ~/.pocket-home out of it
+  DiskImageCache::getInstance().setEnabled(false);
+  auto &cache = SharedImageCache::getInstance();
+
+  TemporaryFile directory;
+  directory.getFile().createDirectory();
+  const auto first = writePng(directory.getFile(), "first.png");
+  const auto second = writePng(directory.getFile(), "second.png");
+
+  {
+    Image held = cache.getImage(first, 16, 16);
+    expect(held.isValid(), "image didn't decode");
+    expect(cache.getImage(first, 16, 16) == held, "same file and size isn't shared");
+    cache.getImage(second, 16, 16);
+    expect(cache.getStats().entries == 2, "both images should be cached");
+
+    cache.releaseUnused();
+    expect(cache.getStats().entries == 1, "unused image wasn't dropped");
+    expect(cache.getStats().misses == 2, "held image was decoded again");
+    expect(cache.getImage(first, 16, 16) == held, "held image was dropped");
+  }
+
+  cache.releaseUnused();
+  expect(cache.getStats().entries == 0, "image wasn't dropped after its owner let go");
+  expect(cache.getStats().bytes == 0, "dropped images still counted");
+
+  directory.getFile().deleteRecursively();
+  if (failures) {
+    std::cerr << failures << " checks failed" << std::endl;
+    return 1;
+  }
+  std::cout << "image cache OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,347 @@
+#include "ImageKernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_KERNELS_SSE2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_KERNELS_NEON 1
+#endif
+
+#if defined(__linux__) && defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace ImageKernels {
+
+namespace {
+
+// Exact round(v / 255) for v in [0, 255 * 255].
+inline uint8_t div255(unsigned v) {
+  v += 128;
+  return (uint8_t)((v + (v >> 8)) >> 8);
+}
+
+// 255 / a in 8.8 fixed point. Integer maths keeps every variant bit identical, float
+// would depend on whether the compiler fuses the multiply-add.
+struct ReciprocalTable {
+  uint16_t values[256];
+  ReciprocalTable() {
+    values[0] = 0;
+    for (int a = 1; a < 256; ++a) values[a] = (uint16_t)((255 * 256 + a / 2) / a);
+  }
+};
+
+const uint16_t *reciprocals() {
+  static ReciprocalTable table;
+  return table.values;
+}
+
+// Leaves alpha alone when used as the alpha lane's factor.
+const uint16_t identityFactor = 256;
+
+inline uint8_t unpremultiplyChannel(uint8_t c, uint16_t reciprocal) {
+  const unsigned v = (c * (unsigned)reciprocal + 128) >> 8;
+  return v > 255 ? 255 : (uint8_t)v;
+}
+
+// --- scalar ---------------------------------------------------------------------------
+
+void premultiplyScalar(uint8_t *p, int n) {
+  for (int i = 0; i < n; ++i, p += 4) {
+    const unsigned a = p[3];
+    p[0] = div255(p[0] * a);
+    p[1] = div255(p[1] * a);
+    p[2] = div255(p[2] * a);
+  }
+}
+
+void unpremultiplyScalar(uint8_t *p, int n) {
+  const uint16_t *recip = reciprocals();
+  for (int i = 0; i < n; ++i, p += 4) {
+    const uint16_t r = recip[p[3]];
+    p[0] = unpremultiplyChannel(p[0], r);
+    p[1] = unpremultiplyChannel(p[1], r);
+    p[2] = unpremultiplyChannel(p[2], r);
+  }
+}
+
+void multiplyAlphaScalar(uint8_t *p, int n, uint8_t alpha) {
+  for (int i = 0; i < n * 4; ++i) {
+    p[i] = div255(p[i] * (unsigned)alpha);
+  }
+}
+
+void halveScalar(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int dstWidth,
+                 int dstHeight) {
+  for (int y = 0; y < dstHeight; ++y) {
+    const uint8_t *a = src + (2 * y) * srcStride;
+    const uint8_t *b = a + srcStride;
+    uint8_t *out = dst + y * dstStride;
+    for (int x = 0; x < dstWidth * 4; ++x) {
+      const int i = (x & ~3) * 2 + (x & 3);
+      out[x] = (uint8_t)((a[i] + a[i + 4] + b[i] + b[i + 4] + 2) >> 2);
+    }
+  }
+}
+
+const Kernels scalarKernels = { "scalar", premultiplyScalar, unpremultiplyScalar,
+                                multiplyAlphaScalar, halveScalar };
+
+// --- SSE2 -----------------------------------------------------------------------------
+
+#if IMAGE_KERNELS_SSE2
+
+// div255 on eight 16 bit lanes
+inline __m128i div255x8(__m128i v) {
+  v = _mm_add_epi16(v, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+// Multiplies the 16 bytes in p by the 16 byte factors in f.
+inline __m128i multiply16(__m128i p, __m128i f) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpacklo_epi8(f, zero));
+  __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), _mm_unpackhi_epi8(f, zero));
+  return _mm_packus_epi16(div255x8(lo), div255x8(hi));
+}
+
+void premultiplySSE2(uint8_t *p, int n) {
+  const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+  int i = 0;
+  for (; i + 4 <= n; i += 4, p += 16) {
+    __m128i px = _mm_loadu_si128((const __m128i *)p);
+    // broadcast each pixel's alpha into its colour bytes, keep 255 for the alpha byte
+    __m128i a = _mm_srli_epi32(px, 24);
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+    a = _mm_or_si128(a, alphaMask);
+    _mm_storeu_si128((__m128i *)p, multiply16(px, a));
+  }
+  premultiplyScalar(p, n - i);
+}
+
+void unpremultiplySSE2(uint8_t *p, int n) {
+  const uint16_t *recip = reciprocals();
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(128);
+  int i = 0;
+  for (; i + 4 <= n; i += 4, p += 16) {
+    __m128i px = _mm_loadu_si128((const __m128i *)p);
+    const uint16_t r0 = recip[p[3]], r1 = recip[p[7]], r2 = recip[p[11]], r3 = recip[p[15]];
+    __m128i results[2];
+    for (int k = 0; k < 2; ++k) {
+      __m128i c = k == 0 ? _mm_unpacklo_epi8(px, zero) : _mm_unpackhi_epi8(px, zero);
+      __m128i f = k == 0 ? _mm_set_epi16(identityFactor, r1, r1, r1, identityFactor, r0, r0, r0)
+                         : _mm_set_epi16(identityFactor, r3, r3, r3, identityFactor, r2, r2, r2);
+      // full 32 bit products from the low and high halves of the 16 bit multiply
+      __m128i lo = _mm_mullo_epi16(c, f);
+      __m128i hi = _mm_mulhi_epu16(c, f);
+      __m128i v0 = _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 8);
+      __m128i v1 = _mm_srli_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 8);
+      results[k] = _mm_packs_epi32(v0, v1);
+    }
+    _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(results[0], results[1]));
+  }
+  unpremultiplyScalar(p, n - i);
+}
+
+void multiplyAlphaSSE2(uint8_t *p, int n, uint8_t alpha) {
+  const __m128i f = _mm_set1_epi8((char)alpha);
+  int i = 0;
+  for (; i + 4 <= n; i += 4, p += 16) {
+    __m128i px = _mm_loadu_si128((const __m128i *)p);
+    _mm_storeu_si128((__m128i *)p, multiply16(px, f));
+  }
+  multiplyAlphaScalar(p, n - i, alpha);
+}
+
+void halveSSE2(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int dstWidth,
+               int dstHeight) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+  for (int y = 0; y < dstHeight; ++y) {
+    const uint8_t *a = src + (2 * y) * srcStride;
+    const uint8_t *b = a + srcStride;
+    uint8_t *out = dst + y * dstStride;
+    int x = 0;
+    // four source pixels per row -> two destination pixels
+    for (; x + 2 <= dstWidth; x += 2) {
+      __m128i ra = _mm_loadu_si128((const __m128i *)(a + x * 8));
+      __m128i rb = _mm_loadu_si128((const __m128i *)(b + x * 8));
+      __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(ra, zero), _mm_unpacklo_epi8(rb, zero));
+      __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(ra, zero), _mm_unpackhi_epi8(rb, zero));
+      // each half holds two horizontally adjacent pixels, fold them together
+      lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+      hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+      __m128i sum = _mm_unpacklo_epi64(lo, hi);
+      sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+      _mm_storel_epi64((__m128i *)(out + x * 4), _mm_packus_epi16(sum, zero));
+    }
+    if (x < dstWidth) {
+      halveScalar(a + x * 8, srcStride, out + x * 4, dstStride, dstWidth - x, 1);
+    }
+  }
+}
+
+const Kernels sse2Kernels = { "sse2", premultiplySSE2, unpremultiplySSE2, multiplyAlphaSSE2,
+                              halveSSE2 };
+
+#endif
+
+// --- NEON -----------------------------------------------------------------------------
+
+#if IMAGE_KERNELS_NEON
+
+// div255 on eight 16 bit lanes, narrowed back to bytes
+inline uint8x8_t div255x8(uint16x8_t v) {
+  v = vaddq_u16(v, vdupq_n_u16(128));
+  return vshrn_n_u16(vaddq_u16(v, vshrq_n_u16(v, 8)), 8);
+}
+
+void premultiplyNEON(uint8_t *p, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8, p += 32) {
+    // de-interleaved load: val[0..3] hold B, G, R, A of eight pixels
+    uint8x8x4_t px = vld4_u8(p);
+    px.val[0] = div255x8(vmull_u8(px.val[0], px.val[3]));
+    px.val[1] = div255x8(vmull_u8(px.val[1], px.val[3]));
+    px.val[2] = div255x8(vmull_u8(px.val[2], px.val[3]));
+    vst4_u8(p, px);
+  }
+  premultiplyScalar(p, n - i);
+}
+
+void unpremultiplyNEON(uint8_t *p, int n) {
+  const uint16_t *recip = reciprocals();
+  int i = 0;
+  for (; i + 4 <= n; i += 4, p += 16) {
+    uint8x16_t px = vld1q_u8(p);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(px));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(px));
+    uint16x4_t channels[4] = { vget_low_u16(lo), vget_high_u16(lo), vget_low_u16(hi),
+                               vget_high_u16(hi) };
+    uint16x4_t results[4];
+    for (int k = 0; k < 4; ++k) {
+      uint16x4_t f = vset_lane_u16(identityFactor, vdup_n_u16(recip[p[k * 4 + 3]]), 3);
+      // saturating narrow, so anything above 255 clamps like the scalar code
+      results[k] = vqrshrn_n_u32(vmull_u16(channels[k], f), 8);
+    }
+    uint8x8_t a = vqmovn_u16(vcombine_u16(results[0], results[1]));
+    uint8x8_t b = vqmovn_u16(vcombine_u16(results[2], results[3]));
+    vst1q_u8(p, vcombine_u8(a, b));
+  }
+  unpremultiplyScalar(p, n - i);
+}
+
+void multiplyAlphaNEON(uint8_t *p, int n, uint8_t alpha) {
+  const uint8x8_t f = vdup_n_u8(alpha);
+  int i = 0;
+  for (; i + 4 <= n; i += 4, p += 16) {
+    uint8x16_t px = vld1q_u8(p);
+    uint8x8_t lo = div255x8(vmull_u8(vget_low_u8(px), f));
+    uint8x8_t hi = div255x8(vmull_u8(vget_high_u8(px), f));
+    vst1q_u8(p, vcombine_u8(lo, hi));
+  }
+  multiplyAlphaScalar(p, n - i, alpha);
+}
+
+void halveNEON(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int dstWidth,
+               int dstHeight) {
+  for (int y = 0; y < dstHeight; ++y) {
+    const uint8_t *a = src + (2 * y) * srcStride;
+    const uint8_t *b = a + srcStride;
+    uint8_t *out = dst + y * dstStride;
+    int x = 0;
+    // sixteen source pixels per row -> eight destination pixels
+    for (; x + 8 <= dstWidth; x += 8) {
+      uint8x8x4_t ra0 = vld4_u8(a + x * 8);
+      uint8x8x4_t ra1 = vld4_u8(a + x * 8 + 32);
+      uint8x8x4_t rb0 = vld4_u8(b + x * 8);
+      uint8x8x4_t rb1 = vld4_u8(b + x * 8 + 32);
+      uint8x8x4_t result;
+      for (int c = 0; c < 4; ++c) {
+        // pairwise adds fold horizontally adjacent pixels of one channel together
+        uint16x8_t sum = vcombine_u16(vpaddl_u8(ra0.val[c]), vpaddl_u8(ra1.val[c]));
+        sum = vaddq_u16(sum, vcombine_u16(vpaddl_u8(rb0.val[c]), vpaddl_u8(rb1.val[c])));
+        result.val[c] = vrshrn_n_u16(sum, 2);
+      }
+      vst4_u8(out + x * 4, result);
+    }
+    if (x < dstWidth) {
+      halveScalar(a + x * 8, srcStride, out + x * 4, dstStride, dstWidth - x, 1);
+    }
+  }
+}
+
+const Kernels neonKernels = { "neon", premultiplyNEON, unpremultiplyNEON, multiplyAlphaNEON,
+                              halveNEON };
+
+#endif
+
+bool cpuSupports(Variant variant) {
+  switch (variant) {
+    case scalar:
+      return true;
+#if IMAGE_KERNELS_SSE2
+    case sse2:
+      return __builtin_cpu_supports("sse2");
+#endif
+#if IMAGE_KERNELS_NEON
+    case neon:
+#if defined(__linux__) && defined(__arm__)
+      return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+      return true; // NEON is mandatory on AArch64
+#endif
+#endif
+    default:
+      return false;
+  }
+}
+
+const Kernels *pickBest() {
+  if (const char *forced = getenv("POCKET_HOME_KERNELS")) {
+    for (int v = 0; v < numVariants; ++v) {
+      auto kernels = getVariant((Variant)v);
+      if (kernels && strcmp(kernels->name, forced) == 0) return kernels;
+    }
+  }
+  for (int v = numVariants; --v > 0;) {
+    if (auto kernels = getVariant((Variant)v)) return kernels;
+  }
+  return &scalarKernels;
+}
+
+} // namespace
+
+const Kernels *getVariant(Variant variant) {
+  if (!cpuSupports(variant)) return nullptr;
+  switch (variant) {
+    case scalar:
+      return &scalarKernels;
+#if IMAGE_KERNELS_SSE2
+    case sse2:
+      return &sse2Kernels;
+#endif
+#if IMAGE_KERNELS_NEON
+    case neon:
+      return &neonKernels;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+const Kernels &get() {
+  static const Kernels *best = pickBest();
+  return *best;
+}
+
+} // namespace ImageKernels
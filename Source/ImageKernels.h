@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// Pixel kernels with scalar, SSE2 and NEON variants, picked once at runtime.
+// Deliberately free of JUCE so they can be tested and benchmarked on their own.
+//
+// 4 byte pixels are expected in JUCE's little endian PixelARGB layout, B G R A in memory,
+// so alpha is the fourth byte. All variants produce bit identical results.
+namespace ImageKernels {
+
+enum Variant { scalar = 0, sse2, neon, numVariants };
+
+struct Kernels {
+  const char *name;
+
+  // c = round(c * a / 255) for the colour channels of straight alpha pixels.
+  void (*premultiply)(uint8_t *pixels, int numPixels);
+  // Inverse of premultiply (lossy where alpha is small), zero alpha gives black.
+  void (*unpremultiply)(uint8_t *pixels, int numPixels);
+  // Scales all four channels of premultiplied pixels by alpha / 255, i.e. draws them at
+  // a constant opacity.
+  void (*multiplyAlpha)(uint8_t *pixels, int numPixels, uint8_t alpha);
+  // 2x2 box filter of 4 byte pixels, dst is dstWidth x dstHeight and src at least twice that.
+  void (*halve)(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int dstWidth,
+                int dstHeight);
+};
+
+// The fastest variant this CPU supports. POCKET_HOME_KERNELS=scalar|sse2|neon overrides.
+const Kernels &get();
+
+// A specific variant, or nullptr if it wasn't compiled in or the CPU can't run it.
+const Kernels *getVariant(Variant variant);
+
+} // namespace ImageKernels
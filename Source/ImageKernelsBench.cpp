@@ -0,0 +1,56 @@
+// Times each image kernel variant on a screen sized image (PocketCHIP is 480x272).
+#include "ImageKernels.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+namespace {
+
+const int width = 480, height = 272, iterations = 200;
+
+template <typename Fn> double microsPerCall(Fn fn) {
+  fn(); // warm up caches and the reciprocal table
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) fn();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main() {
+  const int numPixels = width * height;
+  std::vector<uint8_t> source(numPixels * 4);
+  for (auto &byte : source) byte = (uint8_t)rand();
+  std::vector<uint8_t> pixels(source.size()), half(source.size() / 4);
+
+  std::cout << std::fixed << std::setprecision(1) << "us per " << width << "x" << height
+            << " image" << std::endl;
+  std::cout << std::setw(8) << "variant" << std::setw(13) << "premultiply" << std::setw(15)
+            << "unpremultiply" << std::setw(15) << "multiplyAlpha" << std::setw(10) << "halve"
+            << std::endl;
+
+  for (int v = 0; v < ImageKernels::numVariants; ++v) {
+    auto kernels = ImageKernels::getVariant((ImageKernels::Variant)v);
+    if (!kernels) continue;
+    // each call works on a fresh copy, so repeated passes don't converge to zeros
+    auto reset = [&] { pixels = source; };
+    const double copy = microsPerCall(reset);
+    std::cout << std::setw(8) << kernels->name << std::setw(13)
+              << microsPerCall([&] { reset(); kernels->premultiply(pixels.data(), numPixels); }) - copy
+              << std::setw(15)
+              << microsPerCall([&] { reset(); kernels->unpremultiply(pixels.data(), numPixels); }) - copy
+              << std::setw(15)
+              << microsPerCall([&] { reset(); kernels->multiplyAlpha(pixels.data(), numPixels, 128); }) - copy
+              << std::setw(10)
+              << microsPerCall([&] {
+                   kernels->halve(source.data(), width * 4, half.data(), width * 2, width / 2,
+                                  height / 2);
+                 })
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,110 @@
+// Checks every image kernel variant this CPU can run against the scalar reference.
+#include "ImageKernels.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void fail(const ImageKernels::Kernels &kernels, const char *kernel, int size) {
+  std::cerr << "FAILED! " << kernels.name << " " << kernel << " differs from scalar for "
+            << size << " pixels" << std::endl;
+  failures++;
+}
+
+std::vector<uint8_t> randomPixels(int numPixels, bool premultiplied) {
+  std::vector<uint8_t> pixels(numPixels * 4);
+  for (int i = 0; i < numPixels; ++i) {
+    uint8_t *p = &pixels[i * 4];
+    // plenty of fully transparent and opaque pixels, they're the common edge cases
+    const int r = rand() % 8;
+    p[3] = r == 0 ? 0 : (r == 1 ? 255 : (uint8_t)rand());
+    for (int c = 0; c < 3; ++c) {
+      p[c] = (uint8_t)rand();
+      if (premultiplied && p[c] > p[3]) p[c] = p[3];
+    }
+  }
+  return pixels;
+}
+
+void testPixelKernels(const ImageKernels::Kernels &reference, const ImageKernels::Kernels &kernels,
+                      int numPixels) {
+  auto straight = randomPixels(numPixels, false);
+  auto expected = straight, actual = straight;
+  reference.premultiply(expected.data(), numPixels);
+  kernels.premultiply(actual.data(), numPixels);
+  if (expected != actual) fail(kernels, "premultiply", numPixels);
+
+  auto premultiplied = randomPixels(numPixels, true);
+  expected = premultiplied, actual = premultiplied;
+  reference.unpremultiply(expected.data(), numPixels);
+  kernels.unpremultiply(actual.data(), numPixels);
+  if (expected != actual) fail(kernels, "unpremultiply", numPixels);
+
+  for (int alpha : { 0, 1, 128, 200, 255 }) {
+    expected = premultiplied, actual = premultiplied;
+    reference.multiplyAlpha(expected.data(), numPixels, (uint8_t)alpha);
+    kernels.multiplyAlpha(actual.data(), numPixels, (uint8_t)alpha);
+    if (expected != actual) fail(kernels, "multiplyAlpha", numPixels);
+  }
+}
+
+void testHalve(const ImageKernels::Kernels &reference, const ImageKernels::Kernels &kernels,
+               int dstWidth, int dstHeight) {
+  // odd source sizes and padded strides, like a JUCE image with a trailing column
+  const int srcWidth = dstWidth * 2 + 1, srcHeight = dstHeight * 2 + 1;
+  const int srcStride = srcWidth * 4 + 12, dstStride = dstWidth * 4 + 4;
+  auto src = randomPixels(srcStride * srcHeight / 4, true);
+  std::vector<uint8_t> expected(dstStride * dstHeight, 0), actual = expected;
+  reference.halve(src.data(), srcStride, expected.data(), dstStride, dstWidth, dstHeight);
+  kernels.halve(src.data(), srcStride, actual.data(), dstStride, dstWidth, dstHeight);
+  if (expected != actual) fail(kernels, "halve", dstWidth * dstHeight);
+}
+
+void testKnownValues(const ImageKernels::Kernels &kernels) {
+  uint8_t pixel[4] = { 255, 128, 0, 128 };
+  kernels.premultiply(pixel, 1);
+  if (pixel[0] != 128 || pixel[1] != 64 || pixel[2] != 0 || pixel[3] != 128)
+    fail(kernels, "premultiply (known values)", 1);
+
+  kernels.unpremultiply(pixel, 1);
+  if (pixel[0] != 255 || pixel[1] != 128 || pixel[2] != 0 || pixel[3] != 128)
+    fail(kernels, "unpremultiply (known values)", 1);
+
+  uint8_t opaque[4] = { 255, 255, 255, 255 };
+  kernels.multiplyAlpha(opaque, 1, 128);
+  if (memcmp(opaque, "\x80\x80\x80\x80", 4) != 0) fail(kernels, "multiplyAlpha (known values)", 1);
+}
+
+} // namespace
+
+int main() {
+  srand(1234);
+  auto reference = ImageKernels::getVariant(ImageKernels::scalar);
+
+  for (int v = 0; v < ImageKernels::numVariants; ++v) {
+    auto kernels = ImageKernels::getVariant((ImageKernels::Variant)v);
+    if (!kernels) continue;
+    std::cout << "testing " << kernels->name << std::endl;
+
+    testKnownValues(*kernels);
+    // sizes around the vector widths to cover the scalar tails
+    for (int size : { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 1000 }) {
+      testPixelKernels(*reference, *kernels, size);
+      testHalve(*reference, *kernels, size, 3);
+    }
+    testHalve(*reference, *kernels, 240, 136);
+  }
+
+  std::cout << "best variant: " << ImageKernels::get().name << std::endl;
+  if (failures) {
+    std::cerr << failures << " failures" << std::endl;
+    return 1;
+  }
+  std::cout << "all kernels match" << std::endl;
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include "ImageScaling.h"
+#include "ImageKernels.h"
+
+namespace {
+
+// Source coverage of each destination pixel along one axis.
+struct AxisWeights {
+  Array<int> first;     // first source index under each destination pixel
+  Array<int> count;     // number of source pixels under it
+  Array<float> weights; // count[i] weights per destination pixel, each set sums to 1
+  Array<int> offset;    // where each destination pixel's weights start
+};
+
+AxisWeights computeWeights(int sourceSize, int destSize) {
+  AxisWeights axis;
+  const double scale = double(sourceSize) / destSize;
+  for (int i = 0; i < destSize; ++i) {
+    const double start = i * scale;
+    const double end = jmin(double(sourceSize), (i + 1) * scale);
+    const int first = int(start);
+    const int last = jmin(sourceSize - 1, int(std::ceil(end)) - 1);
+
+    axis.first.add(first);
+    axis.count.add(last - first + 1);
+    axis.offset.add(axis.weights.size());
+    for (int s = first; s <= last; ++s) {
+      const double covered = jmin(end, s + 1.0) - jmax(start, double(s));
+      axis.weights.add(float(covered / scale));
+    }
+  }
+  return axis;
+}
+
+// Halves an ARGB image with the SIMD 2x2 kernel, dropping an odd last row or column.
+Image halveImage(const Image &source) {
+  const int width = source.getWidth() / 2, height = source.getHeight() / 2;
+  Image dest(Image::ARGB, width, height, false);
+  const Image::BitmapData src(source, Image::BitmapData::readOnly);
+  Image::BitmapData dst(dest, Image::BitmapData::writeOnly);
+  ImageKernels::get().halve(src.data, src.lineStride, dst.data, dst.lineStride, width, height);
+  return dest;
+}
+
+} // namespace
+
+Image downsampleImage(const Image &sourceImage, int width, int height) {
+  if (!sourceImage.isValid() || width <= 0 || height <= 0) return Image();
+
+  // big reductions (photos, oversized icons) go down by exact halves first, which is what
+  // the vector kernels are fast at, and the box filter below only does the last step
+  Image source = sourceImage;
+  while (source.isARGB() && source.getWidth() >= width * 2 && source.getHeight() >= height * 2) {
+    source = halveImage(source);
+  }
+
+  const int srcWidth = source.getWidth();
+  const int srcHeight = source.getHeight();
+  if (srcWidth == width && srcHeight == height) return source;
+  if (width > srcWidth || height > srcHeight) {
+    return source.rescaled(width, height, Graphics::highResamplingQuality);
+  }
+
+  const Image::BitmapData src(source, Image::BitmapData::readOnly);
+  Image dest(source.getFormat(), width, height, false);
+  Image::BitmapData dst(dest, Image::BitmapData::writeOnly);
+
+  const int channels = src.pixelStride;
+  auto xAxis = computeWeights(srcWidth, width);
+  auto yAxis = computeWeights(srcHeight, height);
+
+  // horizontal pass into float rows, then a vertical pass over those rows
+  HeapBlock<float> rows((size_t)srcHeight * width * channels);
+  for (int y = 0; y < srcHeight; ++y) {
+    const uint8 *in = src.getLinePointer(y);
+    float *out = rows + (size_t)y * width * channels;
+    for (int x = 0; x < width; ++x) {
+      const float *w = xAxis.weights.getRawDataPointer() + xAxis.offset.getUnchecked(x);
+      const uint8 *p = in + xAxis.first.getUnchecked(x) * channels;
+      for (int c = 0; c < channels; ++c) out[c] = 0;
+      for (int i = 0, n = xAxis.count.getUnchecked(x); i < n; ++i, p += channels) {
+        for (int c = 0; c < channels; ++c) out[c] += w[i] * p[c];
+      }
+      out += channels;
+    }
+  }
+
+  const int rowFloats = width * channels;
+  HeapBlock<float> acc(rowFloats);
+  for (int y = 0; y < height; ++y) {
+    const float *w = yAxis.weights.getRawDataPointer() + yAxis.offset.getUnchecked(y);
+    const int first = yAxis.first.getUnchecked(y);
+    acc.clear(rowFloats);
+    for (int i = 0, n = yAxis.count.getUnchecked(y); i < n; ++i) {
+      const float *row = rows + (size_t)(first + i) * rowFloats;
+      for (int j = 0; j < rowFloats; ++j) acc[j] += w[i] * row[j];
+    }
+
+    uint8 *out = dst.getLinePointer(y);
+    for (int j = 0; j < rowFloats; ++j) {
+      out[j] = (uint8)jlimit(0, 255, int(acc[j] + 0.5f));
+    }
+  }
+
+  return dest;
+}
+
+Rectangle<int> fitImageSize(int sourceWidth, int sourceHeight, int maxWidth, int maxHeight) {
+  if (sourceWidth <= 0 || sourceHeight <= 0 || maxWidth <= 0 || maxHeight <= 0) {
+    return Rectangle<int>();
+  }
+  // the limiting side matches the box exactly, so fitting the result back into the same box
+  // later is an identity transform
+  const int64 scaledWidth = (sourceWidth * (int64)maxHeight + sourceHeight / 2) / sourceHeight;
+  if (scaledWidth <= maxWidth) {
+    return Rectangle<int>((int)jmax<int64>(1, scaledWidth), maxHeight);
+  }
+  const int64 scaledHeight = (sourceHeight * (int64)maxWidth + sourceWidth / 2) / sourceWidth;
+  return Rectangle<int>(maxWidth, (int)jlimit<int64>(1, maxHeight, scaledHeight));
+}
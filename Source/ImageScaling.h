@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Area-averaging (box filter) downsampler. Every destination pixel is the coverage
+// weighted mean of the source pixels under it, which keeps thin lines and text in icons
+// readable where Graphics' bilinear resampling would alias. Works on JUCE's premultiplied
+// pixels directly, so alpha edges don't pick up dark fringes.
+// ARGB images at least twice the target size are first halved with ImageKernels.
+// Upscaling (or a mix of up- and downscaling) falls back to Image::rescaled().
+Image downsampleImage(const Image &source, int width, int height);
+
+// Largest size with the source's aspect ratio that fits in maxWidth x maxHeight.
+Rectangle<int> fitImageSize(int sourceWidth, int sourceHeight, int maxWidth, int maxHeight);
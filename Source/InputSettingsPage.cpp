@@ -22,8 +22,7 @@ lc(lc)
   choosemode.addListener(this);
   
   //Let's check whether there is an option for time format in the config
-  var json = getConfigJSON();
-  if(json["cursor"].toString() == "visible")
+  if(AppConfig::getInstance().isCursorVisible())
     choosemode.setSelectedId(2);
   else choosemode.setSelectedId(1);
   
@@ -52,14 +51,11 @@ void InputSettingsPage::buttonClicked(Button* but){
 
 void InputSettingsPage::comboBoxChanged(ComboBox* c){
   if(c != &choosemode) return;
-  var json = getConfigJSON();
-  DynamicObject* mouse = json.getDynamicObject();
+  auto &config = AppConfig::getInstance();
   String visibility = (c->getSelectedId()==1)?"notvisible":"visible";
-  mouse->setProperty("cursor", visibility);
-  //JSON config has been changed, let's write it to the file
-  File configfile = getConfigFile();
-  String jsonstring = JSON::toString(json);
-  configfile.replaceWithText(jsonstring);
+  config.setCursorVisible(visibility == "visible");
+  //Config has been changed, let's write it to the file
+  config.save();
   
   LookAndFeel& laf = getLookAndFeel();
   PokeLookAndFeel* mc = (PokeLookAndFeel*) &laf;
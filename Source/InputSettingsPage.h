@@ -4,6 +4,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Utils.h"
 #include "Main.h"
+#include "AppConfigModel.h"
 #include "PokeLookAndFeel.h"
 
 using namespace juce;
@@ -0,0 +1,162 @@
+#include "KeymapSync.h"
+
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+
+namespace {
+
+::Display *toDisplay(void *display) {
+  return static_cast<::Display *>(display);
+}
+
+uint64 fnv1a(uint64 hash, const void *data, size_t size) {
+  auto bytes = static_cast<const uint8 *>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+struct KeycodeLine {
+  int keycode;
+  Array<KeySym> keysyms;
+};
+
+// "keycode 10 = 1 exclam F1" into its keycode and keysyms, false for anything else.
+bool parseKeycodeLine(const String &line, KeycodeLine &parsed) {
+  if (!line.startsWith("keycode")) return false;
+  const auto code = line.fromFirstOccurrenceOf("keycode", false, false)
+                        .upToFirstOccurrenceOf("=", false, false).trim();
+  if (code.isEmpty() || !code.containsOnly("0123456789")) return false;
+  parsed.keycode = code.getIntValue();
+
+  const auto names = StringArray::fromTokens(line.fromFirstOccurrenceOf("=", false, false), " \t", "");
+  for (const auto &name : names) {
+    if (name.isEmpty()) continue;
+    KeySym keysym = NoSymbol;
+    if (name != "NoSymbol") {
+      keysym = XStringToKeysym(name.toRawUTF8());
+      if (keysym == NoSymbol && name.startsWithIgnoreCase("0x"))
+        keysym = (KeySym)name.substring(2).getHexValue64();
+      if (keysym == NoSymbol) return false;
+    }
+    parsed.keysyms.add(keysym);
+  }
+  return true;
+}
+
+}
+
+KeymapSync &KeymapSync::getInstance() {
+  static KeymapSync instance;
+  return instance;
+}
+
+KeymapSync::KeymapSync() : file(File("~/.Xmodmap")) {
+  ProcessSupervisor::getInstance().addListener(this);
+}
+
+KeymapSync::~KeymapSync() {
+  ProcessSupervisor::getInstance().removeListener(this);
+  if (display) XCloseDisplay(toDisplay(display));
+}
+
+bool KeymapSync::openDisplay() {
+  if (!display) display = XOpenDisplay(nullptr);
+  return display != nullptr;
+}
+
+int64 KeymapSync::hashServerKeymap() {
+  if (!openDisplay()) return 0;
+  auto dpy = toDisplay(display);
+
+  int minKeycode, maxKeycode, perKeycode;
+  XDisplayKeycodes(dpy, &minKeycode, &maxKeycode);
+  auto keysyms = XGetKeyboardMapping(dpy, minKeycode, maxKeycode - minKeycode + 1, &perKeycode);
+  if (!keysyms) return 0;
+  uint64 hash = 14695981039346656037ULL;
+  hash = fnv1a(hash, &perKeycode, sizeof(perKeycode));
+  hash = fnv1a(hash, keysyms, sizeof(KeySym) * perKeycode * (maxKeycode - minKeycode + 1));
+  XFree(keysyms);
+
+  if (auto modifiers = XGetModifierMapping(dpy)) {
+    hash = fnv1a(hash, modifiers->modifiermap, 8 * modifiers->max_keypermod);
+    XFreeModifiermap(modifiers);
+  }
+  return hash ? (int64)hash : 1;
+}
+
+bool KeymapSync::applyInProcess(const StringArray &lines) {
+  Array<KeycodeLine> changes;
+  for (auto line : lines) {
+    line = line.trim();
+    if (line.isEmpty() || line.startsWithChar('!')) continue;
+    KeycodeLine parsed;
+    if (!parseKeycodeLine(line, parsed)) return false;
+    changes.add(parsed);
+  }
+
+  if (!openDisplay()) return false;
+  auto dpy = toDisplay(display);
+  int minKeycode, maxKeycode, perKeycode;
+  XDisplayKeycodes(dpy, &minKeycode, &maxKeycode);
+  for (const auto &change : changes) {
+    if (change.keycode < minKeycode || change.keycode > maxKeycode) return false;
+  }
+
+  auto current = XGetKeyboardMapping(dpy, minKeycode, maxKeycode - minKeycode + 1, &perKeycode);
+  if (!current) return false;
+  int changed = 0;
+  for (auto &change : changes) {
+    // xmodmap leaves out trailing NoSymbols too, compare the rows padded out
+    bool same = change.keysyms.size() <= perKeycode;
+    const auto row = current + (change.keycode - minKeycode) * perKeycode;
+    for (int i = 0; same && i < perKeycode; ++i) {
+      same = row[i] == (i < change.keysyms.size() ? change.keysyms[i] : NoSymbol);
+    }
+    if (same) continue;
+
+    if (change.keysyms.isEmpty()) change.keysyms.add(NoSymbol);
+    XChangeKeyboardMapping(dpy, change.keycode, change.keysyms.size(),
+                           change.keysyms.getRawDataPointer(), 1);
+    ++changed;
+  }
+  XFree(current);
+  XSync(dpy, False);
+  DBG("KeymapSync: " << changed << " of " << changes.size() << " keycodes needed changing");
+  return true;
+}
+
+void KeymapSync::ensureApplied() {
+  if (xmodmapPid) return;
+  if (!file.existsAsFile()) return;
+
+  const auto modTime = file.getLastModificationTime();
+  if (modTime == appliedModTime && appliedKeymapHash != 0 && hashServerKeymap() == appliedKeymapHash)
+    return;
+
+  StringArray lines;
+  file.readLines(lines);
+  appliedModTime = modTime;
+  if (applyInProcess(lines)) {
+    appliedKeymapHash = hashServerKeymap();
+    return;
+  }
+
+  // the hash is taken once it's done, see processExited()
+  appliedKeymapHash = 0;
+  xmodmapPid = ProcessSupervisor::getInstance().launch("xmodmap \"" + file.getFullPathName() + "\"");
+  if (xmodmapPid < 0) xmodmapPid = 0;
+}
+
+void KeymapSync::processExited(const ProcessSupervisor::ExitInfo &info) {
+  if (info.pid != xmodmapPid) return;
+  xmodmapPid = 0;
+  if (info.exitCode == 0) {
+    appliedKeymapHash = hashServerKeymap();
+  } else {
+    // try again on the next launch
+    appliedModTime = juce::Time();
+  }
+}
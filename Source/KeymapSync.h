@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ProcessSupervisor.h"
+
+// Keeps ~/.Xmodmap in effect without reprogramming the keymap on every app launch, which
+// makes X send MappingNotify to every client. It's only reapplied when the file has changed
+// or something else has changed the server's keymap since we last applied it.
+// Files made of plain "keycode N = keysym ..." lines, like the stock PocketCHIP one, are
+// applied in-process with XChangeKeyboardMapping, touching only keycodes that differ.
+// Anything else (modifier or pointer lines, keysym lines) is handed to xmodmap itself.
+class KeymapSync : private ProcessSupervisor::Listener {
+public:
+  static KeymapSync &getInstance();
+
+  // Message thread only.
+  void ensureApplied();
+
+private:
+  KeymapSync();
+  ~KeymapSync();
+
+  bool openDisplay();
+  // of the whole keyboard and modifier mapping, 0 if it can't be read
+  int64 hashServerKeymap();
+  // false if the file has lines we don't handle
+  bool applyInProcess(const StringArray &lines);
+  void processExited(const ProcessSupervisor::ExitInfo &info) override;
+
+  File file;
+  void *display = nullptr;
+  Time appliedModTime;
+  int64 appliedKeymapHash = 0;
+  // an xmodmap still running from an earlier launch
+  int xmodmapPid = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KeymapSync)
+};
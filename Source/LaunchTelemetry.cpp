@@ -0,0 +1,201 @@
+#include "LaunchTelemetry.h"
+
+const int LaunchTelemetry::bucketUpperBoundsMs[numBuckets - 1] = {
+  100, 250, 500, 750, 1000, 1500, 2000, 3000, 5000, 10000, 20000
+};
+
+namespace {
+
+// "/usr/bin/surf -z 1.2" -> "surf"
+String commandName(const String &command) {
+  return command.trim().upToFirstOccurrenceOf(" ", false, false)
+      .fromLastOccurrenceOf("/", false, false).toLowerCase();
+}
+
+}
+
+LaunchTelemetry &LaunchTelemetry::getInstance() {
+  static LaunchTelemetry instance;
+  return instance;
+}
+
+LaunchTelemetry::LaunchTelemetry()
+: writer([this] { return JSON::toString(toJson()); }) {
+  WindowTracker::getInstance().addListener(this);
+  ProcessSupervisor::getInstance().addListener(this);
+}
+
+LaunchTelemetry::~LaunchTelemetry() {
+  WindowTracker::getInstance().removeListener(this);
+  ProcessSupervisor::getInstance().removeListener(this);
+}
+
+File LaunchTelemetry::getFile() {
+  return File("~/.pocket-home/launch-latency.json");
+}
+
+void LaunchTelemetry::launchStarted(int pid, const String &command, double tapMs) {
+  expireStale();
+  Pending launch = { pid, commandName(command), tapMs };
+  if (launch.command.isEmpty()) return;
+  pending.add(launch);
+  scheduleExpiry();
+}
+
+void LaunchTelemetry::addListener(Listener *listener) {
+  listeners.add(listener);
+}
+
+void LaunchTelemetry::removeListener(Listener *listener) {
+  listeners.remove(listener);
+}
+
+bool LaunchTelemetry::flush() {
+  return writer.flush();
+}
+
+void LaunchTelemetry::windowListed(const WindowTracker::WindowInfo &info) {
+  if (pending.isEmpty()) return;
+
+  // the pid is exact, the class is a guess for apps started through a wrapper script
+  int match = -1;
+  for (int i = 0; i < pending.size() && match < 0; ++i) {
+    if (info.pid > 0 && pending.getReference(i).pid == info.pid) match = i;
+  }
+  for (int i = 0; i < pending.size() && match < 0; ++i) {
+    const auto &command = pending.getReference(i).command;
+    if (command == info.className || command == info.instanceName) match = i;
+  }
+  if (match >= 0) finish(match, true);
+}
+
+void LaunchTelemetry::processExited(const ProcessSupervisor::ExitInfo &info) {
+  for (int i = 0; i < pending.size(); ++i) {
+    if (pending.getReference(i).pid == info.pid) {
+      finish(i, false);
+      return;
+    }
+  }
+}
+
+void LaunchTelemetry::expireStale() {
+  const auto now = Time::getMillisecondCounterHiRes();
+  for (int i = pending.size(); --i >= 0;) {
+    if (now - pending.getReference(i).tapMs < timeoutMs) continue;
+    getHistogram(pending.getReference(i).command).timeouts++;
+    const int pid = pending.getReference(i).pid;
+    pending.remove(i);
+    writer.schedule(getFile());
+    listeners.call(&Listener::launchFinished, pid, false);
+  }
+  scheduleExpiry();
+}
+
+void LaunchTelemetry::scheduleExpiry() {
+  if (pending.isEmpty()) {
+    stopTimer();
+    return;
+  }
+  double oldestTapMs = pending.getReference(0).tapMs;
+  for (const auto &launch : pending) oldestTapMs = jmin(oldestTapMs, launch.tapMs);
+  const double dueMs = oldestTapMs + timeoutMs - Time::getMillisecondCounterHiRes();
+  startTimer(jmax(1, (int)std::ceil(dueMs)));
+}
+
+void LaunchTelemetry::timerCallback() {
+  expireStale();
+}
+
+void LaunchTelemetry::finish(int index, bool windowShown) {
+  const auto launch = pending.getReference(index);
+  pending.remove(index);
+  scheduleExpiry();
+
+  auto &histogram = getHistogram(launch.command);
+  if (windowShown) {
+    const double ms = Time::getMillisecondCounterHiRes() - launch.tapMs;
+    int bucket = 0;
+    while (bucket < numBuckets - 1 && ms > bucketUpperBoundsMs[bucket]) ++bucket;
+    histogram.buckets[bucket]++;
+    histogram.minMs = histogram.count ? jmin(histogram.minMs, ms) : ms;
+    histogram.maxMs = jmax(histogram.maxMs, ms);
+    histogram.totalMs += ms;
+    histogram.count++;
+    DBG("LaunchTelemetry: " << launch.command << " showed a window after " << roundToInt(ms) << "ms");
+  } else {
+    histogram.noWindow++;
+  }
+  writer.schedule(getFile());
+  listeners.call(&Listener::launchFinished, launch.pid, windowShown);
+}
+
+LaunchTelemetry::Histogram &LaunchTelemetry::getHistogram(const String &command) {
+  load();
+  if (!histogramsByCommand.contains(command)) {
+    auto histogram = new Histogram();
+    histogram->command = command;
+    histograms.add(histogram);
+    histogramsByCommand.set(command, histogram);
+  }
+  return *histogramsByCommand[command];
+}
+
+// Picks up earlier sessions' numbers, the first time they're needed.
+void LaunchTelemetry::load() {
+  if (loaded) return;
+  loaded = true;
+
+  const auto json = JSON::parse(getFile());
+  // counts from different bucket bounds can't be added up, start over
+  auto bounds = json["bucketUpperBoundsMs"].getArray();
+  if (!bounds || bounds->size() != numBuckets - 1) return;
+  for (int i = 0; i < numBuckets - 1; ++i) {
+    if ((int)(*bounds)[i] != bucketUpperBoundsMs[i]) return;
+  }
+
+  auto apps = json["apps"].getDynamicObject();
+  if (!apps) return;
+  auto &properties = apps->getProperties();
+  for (int i = 0; i < properties.size(); ++i) {
+    const auto &app = properties.getValueAt(i);
+    auto histogram = new Histogram();
+    histogram->command = properties.getName(i).toString();
+    histogram->count = app["count"];
+    histogram->totalMs = app["totalMs"];
+    histogram->minMs = app["minMs"];
+    histogram->maxMs = app["maxMs"];
+    histogram->noWindow = app["noWindow"];
+    histogram->timeouts = app["timeouts"];
+    if (auto counts = app["counts"].getArray()) {
+      for (int b = 0; b < numBuckets && b < counts->size(); ++b) histogram->buckets[b] = (*counts)[b];
+    }
+    histograms.add(histogram);
+    histogramsByCommand.set(histogram->command, histogram);
+  }
+}
+
+var LaunchTelemetry::toJson() const {
+  Array<var> bounds;
+  for (auto bound : bucketUpperBoundsMs) bounds.add(bound);
+
+  DynamicObject::Ptr apps = new DynamicObject();
+  for (auto histogram : histograms) {
+    DynamicObject::Ptr app = new DynamicObject();
+    Array<var> counts;
+    for (auto count : histogram->buckets) counts.add(count);
+    app->setProperty("count", histogram->count);
+    app->setProperty("meanMs", histogram->count ? histogram->totalMs / histogram->count : 0.0);
+    app->setProperty("minMs", histogram->minMs);
+    app->setProperty("maxMs", histogram->maxMs);
+    app->setProperty("totalMs", histogram->totalMs);
+    app->setProperty("noWindow", histogram->noWindow);
+    app->setProperty("timeouts", histogram->timeouts);
+    app->setProperty("counts", counts);
+    apps->setProperty(histogram->command, app.get());
+  }
+
+  DynamicObject::Ptr document = new DynamicObject();
+  document->setProperty("bucketUpperBoundsMs", bounds);
+  document->setProperty("apps", apps.get());
+  return document.get();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ConfigWriter.h"
+#include "ProcessSupervisor.h"
+#include "WindowTracker.h"
+
+// Times each app launch from the tap to its first window, which is when the window manager
+// lists it in _NET_CLIENT_LIST (see WindowTracker). The window is matched to the launch by
+// _NET_WM_PID, or failing that by WM_CLASS against the command name.
+// Per app latency histograms are kept in ~/.pocket-home/launch-latency.json, so slow
+// starters and regressions after an image update show up across sessions.
+class LaunchTelemetry : private WindowTracker::Listener,
+                        private ProcessSupervisor::Listener,
+                        private Timer {
+public:
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    // The launch is over: its first window showed up, or it exited or timed out without one.
+    virtual void launchFinished(int pid, bool windowShown) = 0;
+  };
+
+  static LaunchTelemetry &getInstance();
+
+  // Upper bounds of the histogram buckets, the last bucket takes everything above.
+  static const int numBuckets = 12;
+  static const int bucketUpperBoundsMs[numBuckets - 1];
+  // a launch without a window after this long counts as timed out, and is finished then
+  static const int timeoutMs = 60 * 1000;
+
+  // Message thread only. tapMs is Time::getMillisecondCounterHiRes() at the tap, command
+  // the shell line the app was started with.
+  void launchStarted(int pid, const String &command, double tapMs);
+
+  void addListener(Listener *listener);
+  void removeListener(Listener *listener);
+
+  static File getFile();
+  // Writes out anything recorded but not saved yet, for shutdown.
+  bool flush();
+
+private:
+  LaunchTelemetry();
+  ~LaunchTelemetry();
+
+  struct Pending {
+    int pid;
+    String command; // the executable's file name, lower case
+    double tapMs;
+  };
+
+  struct Histogram {
+    String command;
+    int count = 0;
+    double totalMs = 0, minMs = 0, maxMs = 0;
+    int buckets[numBuckets] = {};
+    // launches that exited, or gave up, before showing a window
+    int noWindow = 0, timeouts = 0;
+  };
+
+  void windowListed(const WindowTracker::WindowInfo &info) override;
+  void processExited(const ProcessSupervisor::ExitInfo &info) override;
+
+  void finish(int index, bool windowShown);
+  void expireStale();
+  // runs expireStale() when the oldest pending launch times out, idle with none pending
+  void scheduleExpiry();
+  void timerCallback() override;
+  Histogram &getHistogram(const String &command);
+  void load();
+  var toJson() const;
+
+  Array<Pending> pending;
+  OwnedArray<Histogram> histograms;
+  HashMap<String, Histogram *> histogramsByCommand;
+  bool loaded = false;
+
+  ListenerList<Listener> listeners;
+  ConfigWriter writer;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LaunchTelemetry)
+};
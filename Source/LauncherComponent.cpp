@@ -5,30 +5,12 @@
 #include "PowerPageComponent.h"
 
 #include "Main.h"
+#include "StartupProfiler.h"
 #include "Utils.h"
+#include "SharedImageCache.h"
 #include <math.h>
 #include <algorithm>
 
-void LaunchSpinnerTimer::timerCallback() {
-  if (launcherComponent) {
-    auto lsp = launcherComponent->launchSpinner.get();
-    const auto& lspImg = launcherComponent->launchSpinnerImages;
-    
-    // change image
-    i++;
-    if (i == lspImg.size()) { i = 0; }
-    lsp->setImage(lspImg[i]);
-    
-    // check timeout
-    t += getTimerInterval();
-    if (t > timeout) {
-      t = 0;
-      lsp->setVisible(false);
-      stopTimer();
-    }
-  }
-}
-
 void BatteryIconTimer::timerCallback() {
   
   // get current battery status from the battery monitor thread
@@ -79,8 +61,14 @@ void BatteryIconTimer::timerCallback() {
   
 }
 
+void PagePrewarmTimer::timerCallback() {
+  if (!launcherComponent || !launcherComponent->prewarmNextPage()) stopTimer();
+}
+
 void WifiIconTimer::timerCallback() {
   if(!launcherComponent) { return; }
+  // keep the initial icon until NetworkManager has told us anything
+  if(!getWifiStatus().isInitialized()) { return; }
     
   for( auto button : launcherComponent->topButtons->buttons ) {
     if (button->getName() == "WiFi") {
@@ -125,8 +113,10 @@ void LauncherComponent::setColorBackground(const String& str){
     std::stringstream ss;
     ss << std::hex << value;
     ss >> x;
-    bgColor = Colour(x);
     hasImg = false;
+    wallpaperLoader.cancel();
+    bgSurface.setImage(Image());
+    bgSurface.setColour(Colour(x));
 }
 
 void LauncherComponent::setImageBackground(const String& str){
@@ -135,8 +125,28 @@ void LauncherComponent::setImageBackground(const String& str){
     File f;
     if(value[0]=='~' || value[0]=='/') f = File(value);
     else f = assetFile(value);
-    bgImage = createImageFromFile(f);
+    bgImageFile = f;
     hasImg = true;
+    wallpaperLoader.cancel();
+    loadWallpaper();
+}
+
+void LauncherComponent::setBackground(const String &value) {
+  if(value.length()==6 && value.containsOnly("0123456789ABCDEF"))
+    setColorBackground(value);
+  else
+    setImageBackground(value);
+}
+
+void LauncherComponent::loadWallpaper() {
+  // nothing to decode for until we've been given a size, resized() calls back here
+  if (!hasImg || getWidth() <= 0 || getHeight() <= 0) return;
+  wallpaperLoader.load(bgImageFile, getWidth(), getHeight());
+}
+
+void LauncherComponent::wallpaperLoaded(const File &file, const Image &image) {
+  if (!hasImg || file != bgImageFile) return;
+  bgSurface.setImage(image);
 }
 
 void LauncherComponent::setClockVisible(bool visible){
@@ -156,8 +166,8 @@ void LauncherComponent::setClockAMPM(bool ampm){
   clock->setAmMode(ampm);
 }
 
-LauncherComponent::LauncherComponent(const var &configJson) :
-clock(nullptr), labelip("ip", "")
+LauncherComponent::LauncherComponent(AppConfig &config) :
+labelip("ip", ""), bgSurface(*this, Colour(0x4D4D4D)), wallpaperLoader(this), clock(nullptr)
 {
   /* Ip settings */
   labelip.setVisible(false);
@@ -165,14 +175,8 @@ clock(nullptr), labelip("ip", "")
   /* Setting the clock */
   clock = new ClockMonitor;
   clock->getLabel().setBounds(380, 0, 50, 50);
-  String displayclock = (configJson["showclock"]).toString();
-  String formatclock = (configJson["timeformat"]).toString();
-  if(displayclock.length()==0 || displayclock==String("yes"))
-    setClockVisible(true);
-  else
-    setClockVisible(false);
-  
-  setClockAMPM(formatclock == "ampm");
+  setClockVisible(config.isClockShown());
+  setClockAMPM(config.getTimeFormat() == "ampm");
   
   /* Battery percentage label */
   batteryLabel = new Label("percentage", "-%");
@@ -182,13 +186,7 @@ clock(nullptr), labelip("ip", "")
 //   batteryLabel->setAlwaysOnTop(true);
 //   batteryLabel->addToDesktop(ComponentPeer::StyleFlags::windowIsSemiTransparent);
   
-  String value = (configJson["background"]).toString();
-  
-  bgColor = Colour(0x4D4D4D);
-  if(value.length()==6 && value.containsOnly("0123456789ABCDEF"))
-    setColorBackground(value);
-  else
-    setImageBackground(value);
+  setBackground(config.getBackground());
   
   pageStack = new PageStackComponent();
   addAndMakeVisible(pageStack);
@@ -200,33 +198,29 @@ clock(nullptr), labelip("ip", "")
   addAndMakeVisible(topButtons);
   addAndMakeVisible(botButtons);
   
-  Array<String> wifiImgPaths{"wifiStrength0.png","wifiStrength1.png","wifiStrength2.png","wifiStrength3.png","wifiOff.png"};
-  for(auto& path : wifiImgPaths) {
-    auto image = createImageFromFile(assetFile(path));
-    wifiIconImages.add(image);
-  }
-  
-  Array<String> batteryImgPaths{"battery_1.png","battery_2.png","battery_3.png","battery_0.png"};
-  for(auto& path : batteryImgPaths) {
-    auto image = createImageFromFile(assetFile(path));
-    batteryIconImages.add(image);
-  }
-    
-  Array<String> batteryImgChargingPaths{"batteryCharging_1.png","batteryCharging_2.png","batteryCharging_3.png","batteryCharging_0.png"};
-  for(auto& path : batteryImgChargingPaths) {
-    auto image = createImageFromFile(assetFile(path));
-    batteryIconChargingImages.add(image);
-  }
+  {
+    StartupPhase phase("status icons");
+    Array<String> wifiImgPaths{"wifiStrength0.png","wifiStrength1.png","wifiStrength2.png","wifiStrength3.png","wifiOff.png"};
+    for(auto& path : wifiImgPaths) {
+      auto image = createImageFromFile(assetFile(path));
+      wifiIconImages.add(image);
+    }
 
-  launchSpinnerTimer.launcherComponent = this;
-  Array<String> spinnerImgPaths{"wait0.png","wait1.png","wait2.png","wait3.png","wait4.png","wait5.png","wait6.png","wait7.png"};
-  for(auto& path : spinnerImgPaths) {
-    auto image = createImageFromFile(assetFile(path));
-    launchSpinnerImages.add(image);
+    Array<String> batteryImgPaths{"battery_1.png","battery_2.png","battery_3.png","battery_0.png"};
+    for(auto& path : batteryImgPaths) {
+      auto image = createImageFromFile(assetFile(path));
+      batteryIconImages.add(image);
+    }
+
+    Array<String> batteryImgChargingPaths{"batteryCharging_1.png","batteryCharging_2.png","batteryCharging_3.png","batteryCharging_0.png"};
+    for(auto& path : batteryImgChargingPaths) {
+      auto image = createImageFromFile(assetFile(path));
+      batteryIconChargingImages.add(image);
+    }
   }
-  
-  launchSpinner = new ImageComponent();
-  launchSpinner->setImage(launchSpinnerImages[0]);
+
+  // shown until the launch finishes, see AppsPageComponent::launchFinished()
+  launchSpinner = new SpinnerComponent("Launch Spinner", "wait");
   launchSpinner->setInterceptsMouseClicks(false, false);
   addChildComponent(launchSpinner);
   
@@ -235,58 +229,50 @@ clock(nullptr), labelip("ip", "")
   addChildComponent(focusButtonPopup);
   
   // Settings page
-  auto settingsPage = new SettingsPageComponent(this);
-  settingsPage->addChildComponent(labelip);
-  settingsPage->setName("Settings");
-  pages.add(settingsPage);
-  pagesByName.set("Settings", settingsPage);
+  pageFactories.set("Settings", [this] {
+    auto settingsPage = new SettingsPageComponent(this);
+    settingsPage->addChildComponent(labelip);
+    return (Component *)settingsPage;
+  });
   
   // Power page
-  auto powerPage = new PowerPageComponent();
-  powerPage->setName("Power");
-  pages.add(powerPage);
-  pagesByName.set("Power", powerPage);
+  pageFactories.set("Power", [] { return (Component *)new PowerPageComponent(); });
   
   // Apps page
   /* Check whether we have to display vertically the icons
    * Checking "VERTICAL" lets horizontal direction be the default one
    */
-  bool vertical = (configJson["direction"].toString()=="VERTICAL");
-    auto appsPage = new AppsPageComponent(this, !vertical);
+  auto appsPage = createTimed<AppsPageComponent>("apps page", this, !config.isVertical());
   appsPage->setName("Apps");
   pages.add(appsPage);
   pagesByName.set("Apps", appsPage);
   
-  // Apps library
-  auto appsLibrary = new LibraryPageComponent();
-  appsLibrary->setName("AppsLibrary");
-  pages.add(appsLibrary);
-  pagesByName.set("AppsLibrary", appsLibrary);
+  // Apps library, showing the same apps
+  auto configPtr = &config;
+  pageFactories.set("AppsLibrary", [configPtr] {
+    auto appsLibrary = new LibraryPageComponent();
+    appsLibrary->createIconsFromConfig(*configPtr);
+    return (Component *)appsLibrary;
+  });
   
-  // Read config for apps and corner locations
-  auto pagesData = configJson["pages"].getArray();
-  if (pagesData) {
-    for (const auto &page : *pagesData) {
-      auto name = page["name"].toString();
-      if (name == "Apps") {
-        
-        const auto& appButtons = appsPage->createIconsFromJsonArray(page["items"]);
-        for (auto button : appButtons) { button->setWantsKeyboardFocus(false); }
-        appsLibrary->createIconsFromJsonArray(page["items"]);
-        auto buttonsData = *(page["cornerButtons"].getArray());
-        
-        // FIXME: is there a better way to slice juce Array<var> ?
-        Array<var> topData{};
-        Array<var> botData{};
-        topData.add(buttonsData[0]);
-        topData.add(buttonsData[1]);
-        botData.add(buttonsData[2]);
-        botData.add(buttonsData[3]);
-        
-        topButtons->addButtonsFromJsonArray(topData);
-        botButtons->addButtonsFromJsonArray(botData);
-      }
-    }
+  // Apps and corner locations from the config
+  {
+    StartupPhase phase("app icons");
+    const auto& appButtons = appsPage->createIconsFromConfig(config);
+    for (auto button : appButtons) { button->setWantsKeyboardFocus(false); }
+  }
+  auto buttonsData = config.getCornerButtons();
+  if (buttonsData.size() >= 4) {
+    // FIXME: is there a better way to slice juce Array<var> ?
+    Array<var> topData{};
+    Array<var> botData{};
+    topData.add(buttonsData[0]);
+    topData.add(buttonsData[1]);
+    botData.add(buttonsData[2]);
+    botData.add(buttonsData[3]);
+    
+    topButtons->addButtonsFromJsonArray(topData);
+    botButtons->addButtonsFromJsonArray(botData);
   }
   
   // NOTE(ryan): Maybe do something with a custom event later.. For now we just listen to all the
@@ -300,7 +286,7 @@ clock(nullptr), labelip("ip", "")
     button->setWantsKeyboardFocus(false);
   }
 
-  defaultPage = pagesByName[configJson["defaultPage"]];
+  defaultPage = getPage(config.getDefaultPage());
   
   batteryMonitor.updateStatus();
   batteryMonitor.startThread();
@@ -313,23 +299,34 @@ clock(nullptr), labelip("ip", "")
   wifiIconTimer.startTimer(2000);
   wifiIconTimer.timerCallback();
 
+  // optional, pages are built on first use either way
+  if (config.shouldPrewarmPages()) {
+    pagePrewarmTimer.launcherComponent = this;
+    pagePrewarmTimer.startTimer(1000);
+  }
+
+  config.addListener(this);
 }
 
 LauncherComponent::~LauncherComponent() {
+  AppConfig::getInstance().removeListener(this);
+  pagePrewarmTimer.stopTimer();
   batteryIconTimer.stopTimer();
   batteryMonitor.stopThread(2000);
 }
 
 void LauncherComponent::paint(Graphics &g) {
-  auto bounds = getLocalBounds();
-  g.fillAll(bgColor);
-  if(hasImg) g.drawImage(bgImage,bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(), 0, 0, bgImage.getWidth(), bgImage.getHeight(), false);
+  bgSurface.paint(g);
   //g.drawImage(trashButton, bounds.getX()+395, bounds.getY()+16, 40, 20, 0, 0, 50, 50, false);
 }
 
 void LauncherComponent::resized() {
   auto bounds = getLocalBounds();
   int barSize = 50;
+
+  // the old wallpaper is stretched once until the one decoded at the new size arrives
+  bgSurface.resized();
+  loadWallpaper();
   
   topButtons->setBounds(bounds.getX(), bounds.getY(), bounds.getWidth(),
                         barSize);
@@ -380,9 +377,50 @@ void LauncherComponent::setIpVisible(bool v){
   labelip.setVisible(v);
 }
 
-void LauncherComponent::addIcon(const String& name, const String& path, const String& shell){
+Component *LauncherComponent::getPage(const String &name) {
+  if (pagesByName.contains(name)) return pagesByName[name];
+  if (!pageFactories.contains(name)) return nullptr;
+
+  StartupPhase phase(name.toRawUTF8());
+  auto page = pageFactories[name]();
+  page->setName(name);
+  pages.add(page);
+  pagesByName.set(name, page);
+  return page;
+}
+
+bool LauncherComponent::hasPage(const String &name) const {
+  return pagesByName.contains(name) || pageFactories.contains(name);
+}
+
+bool LauncherComponent::prewarmNextPage() {
+  // most likely to be opened first
+  static const char *const order[] = { "Settings", "AppsLibrary", "Power" };
+  const char *next = nullptr;
+  for (auto name : order) {
+    if (pageFactories.contains(name) && !pagesByName.contains(name)) {
+      next = name;
+      break;
+    }
+  }
+  if (!next) return false;
+
+  // idle means no touches for a few seconds and no page transition running
+  const auto lastTouch = Desktop::getInstance().getMainMouseSource().getLastMouseDownTime();
+  const auto lastActivity = jmax(lastTouch, constructionTime);
+  if (Time::getCurrentTime() - lastActivity < RelativeTime::seconds(3) ||
+      Desktop::getInstance().getAnimator().isAnimating()) {
+    return true;
+  }
+
+  DBG("LauncherComponent::prewarmNextPage - building " << next);
+  getPage(next);
+  return true;
+}
+
+void LauncherComponent::addIcon(const AppItem &app){
   AppsPageComponent* appsPage = (AppsPageComponent*) pagesByName["Apps"];
-  DrawableButton* db = appsPage->createAndOwnIcon(name, path, shell);
+  DrawableButton* db = appsPage->createAndOwnIcon(app);
   db->setWantsKeyboardFocus(false);
   appsPage->grid->showCurrentPage();
   appsPage->checkShowPageNav();
@@ -391,25 +429,23 @@ void LauncherComponent::addIcon(const String& name, const String& path, const St
 void LauncherComponent::showLaunchSpinner() {
   DBG("Show launch spinner");
   launchSpinner->setVisible(true);
-  launchSpinnerTimer.startTimer(500);
 }
 
 void LauncherComponent::hideLaunchSpinner() {
   DBG("Hide launch spinner");
-  launchSpinnerTimer.stopTimer();
   launchSpinner->setVisible(false);
 }
 
 void LauncherComponent::showAppsLibrary() {
-  getMainStack().pushPage(pagesByName["AppsLibrary"], PageStackComponent::kTransitionTranslateHorizontalLeft);
+  getMainStack().pushPage(getPage("AppsLibrary"), PageStackComponent::kTransitionTranslateHorizontalLeft);
 }
 
 void LauncherComponent::buttonClicked(Button *button) {
   auto currentPage = pageStack->getCurrentPage();
   
   if ((!currentPage || currentPage->getName() != button->getName()) &&
-      pagesByName.contains(button->getName())) {
-    auto page = pagesByName[button->getName()];
+      hasPage(button->getName())) {
+    auto page = getPage(button->getName());
     if (button->getName() == "Settings") {
       getMainStack().pushPage(page, PageStackComponent::kTransitionTranslateHorizontal);
     } else if (button->getName() == "Power") {
@@ -420,10 +456,30 @@ void LauncherComponent::buttonClicked(Button *button) {
   }
 }
 
-void LauncherComponent::deleteIcon(String name, String shell, Component* button){
-  SettingsPageComponent* system = (SettingsPageComponent*) pagesByName["Settings"];
-  system->deleteIcon(name,shell);
+void LauncherComponent::configChanged(const AppConfig::Changes &changes) {
+  auto &config = AppConfig::getInstance();
+  if (changes.clockChanged) {
+    setClockVisible(config.isClockShown());
+    setClockAMPM(config.getTimeFormat() == "ampm");
+  }
+  if (changes.backgroundChanged) setBackground(config.getBackground());
+
+  // a library page that hasn't been built yet will be built from the new config anyway
+  if (changes.appsChanged()) {
+    for (auto name : { "Apps", "AppsLibrary" }) {
+      if (pagesByName.contains(name))
+        ((AppListComponent *)pagesByName[name])->applyConfigChanges(config, changes);
+    }
+    // icons of removed apps, or of ones that now use another image
+    SharedImageCache::getInstance().releaseUnusedSoon();
+  }
+}
+
+void LauncherComponent::deleteIcon(AppIconButton *button){
+  auto &config = AppConfig::getInstance();
+  if (config.removeApp(button->appId)) config.save();
   /* Deleting graphically, without rebooting the app */
   AppsPageComponent* appsPage = (AppsPageComponent*) pagesByName["Apps"];
   appsPage->removeIcon(button);
+  SharedImageCache::getInstance().releaseUnusedSoon();
 }
@@ -7,6 +7,10 @@
 #include "BatteryMonitor.h"
 #include "SwitchComponent.h"
 #include "ClockMonitor.hpp"
+#include "WallpaperLoader.h"
+#include "SpinnerComponent.h"
+#include "BackgroundSurface.h"
+#include "AppConfigModel.h"
 #include <sstream>
 
 #include <sys/types.h>
@@ -19,18 +23,7 @@
 class LauncherComponent;
 class LibraryPageComponent;
 class AppsPageComponent;
-
-class LaunchSpinnerTimer : public Timer {
-public:
-    LaunchSpinnerTimer() {};
-    void timerCallback();
-  
-    LauncherComponent* launcherComponent;
-  
-    int i = 0;
-    int t = 0;
-    int timeout = 30 * 1000;
-};
+class AppIconButton;
 
 class BatteryIconTimer : public Timer {
 public:
@@ -46,15 +39,23 @@ public:
   LauncherComponent* launcherComponent;
 };
 
-class LauncherComponent : public Component, private Button::Listener {
+// Builds the secondary pages ahead of time, once the launcher has been left alone.
+class PagePrewarmTimer : public Timer {
+public:
+  PagePrewarmTimer() {};
+  void timerCallback();
+  LauncherComponent* launcherComponent;
+};
+
+class LauncherComponent : public Component, private Button::Listener,
+                          private WallpaperLoader::Listener, private AppConfig::Listener {
 public:
     BatteryMonitor batteryMonitor;
     ScopedPointer<LauncherBarComponent> botButtons;
     ScopedPointer<LauncherBarComponent> topButtons;
-    ScopedPointer<ImageComponent> launchSpinner;
+    ScopedPointer<SpinnerComponent> launchSpinner;
     ScopedPointer<ImageComponent> focusButtonPopup;
   
-    Array<Image> launchSpinnerImages;
     Array<Image> batteryIconImages;
     Array<Image> batteryIconChargingImages;
     Array<Image> wifiIconImages;
@@ -62,9 +63,9 @@ public:
     ScopedPointer<Label> batteryLabel;
     ScopedPointer<Label> modeLabel;
   
-    LaunchSpinnerTimer launchSpinnerTimer;
     BatteryIconTimer batteryIconTimer;
     WifiIconTimer wifiIconTimer;
+    PagePrewarmTimer pagePrewarmTimer;
     Component* defaultPage;
   
     // FIXME: we have no need for the pages/pagesByName if we're using scoped pointers for each page.
@@ -72,12 +73,14 @@ public:
     OwnedArray<Component> pages;
     ScopedPointer<PageStackComponent> pageStack;
     HashMap<String, Component *> pagesByName;
+    // Pages other than Apps are built on first use, see getPage()
+    HashMap<String, std::function<Component *()>> pageFactories;
     
     bool resize = false;
     
     StretchableLayoutManager categoryButtonLayout;
     
-    LauncherComponent(const var &configJson);
+    LauncherComponent(AppConfig &config);
     ~LauncherComponent();
     
     void paint(Graphics &) override;
@@ -85,25 +88,42 @@ public:
     void updateIp();
     void setIpVisible(bool);
   
+    // Builds the page the first time it's asked for, nullptr for unknown names.
+    Component *getPage(const String &name);
+    bool hasPage(const String &name) const;
+    // Builds one page that hasn't been built yet if the user has been idle for a while.
+    // Returns false once there is nothing left to build.
+    bool prewarmNextPage();
+
     void showAppsLibrary();
     void showLaunchSpinner();
     void hideLaunchSpinner();
 
-    void deleteIcon(String,String,Component*);
+    // Removes the app from the config and the grid
+    void deleteIcon(AppIconButton *button);
     void setClockAMPM(bool);
-    void addIcon(const String&, const String&, const String&);
+    // Adds a grid icon for an app already in the config
+    void addIcon(const AppItem &app);
     void setColorBackground(const String&);
     void setImageBackground(const String&);
+    // A hex colour or an image path, as config.json's "background"
+    void setBackground(const String&);
     void setClockVisible(bool);
     
 private:
-    Colour bgColor;
     Label labelip;
-    Image bgImage;
+    BackgroundSurface bgSurface;
     bool hasImg;
+    Time constructionTime = Time::getCurrentTime();
+    // wallpapers are decoded off the message thread, at the component's size
+    File bgImageFile;
+    WallpaperLoader wallpaperLoader;
     ScopedPointer<ClockMonitor> clock;
   
     void buttonClicked(Button *) override;
+    void loadWallpaper();
+    void wallpaperLoaded(const File &file, const Image &image) override;
+    void configChanged(const AppConfig::Changes &changes) override;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LauncherComponent)
 };
@@ -0,0 +1,153 @@
+// Scaling benchmark for large app libraries: parsing config.json, building the app grid,
+// paging through it and removing icons, with 10 up to 5000 apps (or the sizes given as
+// arguments). Prints one JSON object per library size.
+// The icons are plain DrawableButtons showing a placeholder, like an AppIconButton before
+// its image has loaded; AppIconButton itself would pull in the whole launcher.
+// JUCE components want an X display, run it under xvfb-run on a headless box.
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AppConfigModel.h"
+#include "Grid.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdlib.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// how many removals and config edits are timed per size
+const int numEdits = 50;
+
+double microsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Best of a few runs, the short ones are noisy.
+double bestMillis(int runs, std::function<void()> fn) {
+  double best = -1;
+  for (int i = 0; i < runs; ++i) {
+    const auto start = Clock::now();
+    fn();
+    const double ms = microsSince(start) / 1000.0;
+    if (best < 0 || ms < best) best = ms;
+  }
+  return best;
+}
+
+int64 readRssKb() {
+  StringArray lines;
+  File("/proc/self/status").readLines(lines);
+  for (const auto &line : lines) {
+    if (line.startsWith("VmRSS:"))
+      return line.fromFirstOccurrenceOf(":", false, false).trim().getLargeIntValue();
+  }
+  return -1;
+}
+
+// Mean and worst case of a step repeated count times, in microseconds.
+var timeSteps(int count, std::function<void()> step) {
+  double total = 0, worst = 0;
+  for (int i = 0; i < count; ++i) {
+    const auto start = Clock::now();
+    step();
+    const double us = microsSince(start);
+    total += us;
+    worst = jmax(worst, us);
+  }
+  DynamicObject::Ptr timing = new DynamicObject();
+  timing->setProperty("count", count);
+  timing->setProperty("meanUs", count ? total / count : 0.0);
+  timing->setProperty("maxUs", worst);
+  return timing.get();
+}
+
+String makeConfig(int numApps) {
+  String items;
+  items.preallocateBytes((size_t)numApps * 96);
+  for (int i = 0; i < numApps; ++i) {
+    items << (i ? ",\n" : "") << "    {\"name\": \"App " << i << "\", \"icon\": \"appIcons/app"
+          << (i % 20) << ".png\", \"shell\": \"app" << i << " --some-flag\"}";
+  }
+  return "{\n  \"background\": \"4D4D4D\",\n  \"timeformat\": \"24h\",\n  \"pages\": [\n"
+         "  {\"name\": \"Apps\", \"items\": [\n" + items + "\n  ],\n"
+         "   \"cornerButtons\": [{\"name\": \"Settings\"}, {\"name\": \"Power\"}, {\"name\": \"Apps\"}, {\"name\": \"AppsLibrary\"}]},\n"
+         "  {\"name\": \"Settings\"}\n  ]\n}\n";
+}
+
+var runSize(int numApps) {
+  DynamicObject::Ptr result = new DynamicObject();
+  const auto text = makeConfig(numApps);
+  result->setProperty("apps", numApps);
+  result->setProperty("configBytes", (int64)text.getNumBytesAsUTF8());
+
+  auto &config = AppConfig::getInstance();
+  result->setProperty("parseMs", bestMillis(5, [&] { config.loadFromString(text); }));
+  // for comparison, JUCE's generic parser into a var tree
+  result->setProperty("jsonParseMs", bestMillis(5, [&] { JSON::parse(text); }));
+  // what every coalesced config write costs the message thread
+  result->setProperty("serializeMs", bestMillis(5, [&] { JSON::toString(config.toJson()); }));
+
+  // icons and grid, as AppListComponent builds them
+  const auto rssBefore = readRssKb();
+  const auto buildStart = Clock::now();
+  Image placeholder(Image::ARGB, 64, 64, true);
+  OwnedArray<Component> icons;
+  ScopedPointer<Grid> grid = new Grid(3, 2);
+  grid->setBounds(0, 0, 480, 222);
+  for (auto app : config.getApps()) {
+    auto button = new DrawableButton(app->name, DrawableButton::ImageAboveTextLabel);
+    DrawableImage image;
+    image.setImage(placeholder);
+    button->setImages(&image);
+    icons.add(button);
+    grid->addItem(button);
+  }
+  grid->showCurrentPage();
+  result->setProperty("gridBuildMs", microsSince(buildStart) / 1000.0);
+  result->setProperty("gridRssKb", readRssKb() - rssBefore);
+  result->setProperty("pages", grid->pages.size());
+
+  const int steps = grid->pages.size() - 1;
+  result->setProperty("nextPage", timeSteps(steps, [&] { grid->showNextPage(); }));
+  result->setProperty("prevPage", timeSteps(steps, [&] { grid->showPrevPage(); }));
+
+  // removing from the first page shifts an icon over from every page after it.
+  // The grid can't go down to no icons at all, keep the last one.
+  grid->showPageAtIndex(0);
+  const int removals = jmin(numEdits, numApps - 1);
+  result->setProperty("removeItem", timeSteps(removals, [&] {
+    auto item = grid->page->items.getFirst();
+    grid->removeItem(item);
+    icons.removeObject(item);
+  }));
+
+  result->setProperty("configMove", timeSteps(jmin(numEdits, numApps), [&] {
+    config.moveApp(config.getApps().getFirst()->id, 1);
+  }));
+  result->setProperty("configRemove", timeSteps(jmin(numEdits, config.getApps().size()), [&] {
+    config.removeApp(config.getApps().getFirst()->id);
+  }));
+
+  grid = nullptr;
+  return result.get();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ScopedJuceInitialiser_GUI juce;
+
+  Array<int> sizes{ 10, 100, 1000, 5000 };
+  if (argc > 1) {
+    sizes.clear();
+    for (int i = 1; i < argc; ++i) sizes.add(atoi(argv[i]));
+  }
+
+  for (auto numApps : sizes) {
+    if (numApps <= 0) continue;
+    std::cout << JSON::toString(runSize(numApps), true) << std::endl;
+  }
+  return 0;
+}
@@ -29,6 +29,7 @@ void LibraryPageComponent::resized() {
   auto gridHeight = b.getHeight() - (2.1*btnHeight);
   grid->setSize(gridWidth, gridHeight);
   grid->setBoundsToFit(b.getX(), b.getY(), b.getWidth(), b.getHeight(), Justification::centred, true);
+  updateIconPriorities();
   
   backButton->setBounds(b.getWidth()-60, b.getY(), 60, b.getHeight());
 }
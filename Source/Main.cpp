@@ -2,6 +2,18 @@
 #include "MainComponent.h"
 #include "WifiStatus.h"
 #include "Utils.h"
+#include "SharedImageCache.h"
+#include "DiskImageCache.h"
+#include "AssetResolver.h"
+#include "IconLoader.h"
+#include "StartupProfiler.h"
+#include "AsyncInit.h"
+#include "AppConfigModel.h"
+#include "WindowTracker.h"
+#include "AppCgroups.h"
+#include "ProcessSupervisor.h"
+#include "LaunchTelemetry.h"
+#include "StartupBench.h"
 #include <sys/types.h>
 #include <sys/wait.h>
 
@@ -39,15 +51,6 @@ BluetoothStatus &getBluetoothStatus() {
   return PokeLaunchApplication::get()->bluetoothStatus;
 }
 
-File getConfigFile(){
-    static File configfile = assetConfigFile("config.json");
-    return  configfile;
-}
-
-var getConfigJSON(){
-    static var configjson = JSON::parse(getConfigFile());
-    return configjson;
-}
 
 PokeLaunchApplication::PokeLaunchApplication() {}
 
@@ -149,32 +152,68 @@ bool PokeLaunchApplication::sound() {
 }
 
 void PokeLaunchApplication::initialise(const String &commandLine) {
-  StringArray args;
   args.addTokens(commandLine, true);
 
+  // first, so every phase below is on the clock
+  for (const auto &arg : args) {
+    if (arg == "--profile-startup") {
+      StartupProfiler::getInstance().enable();
+    } else if (arg.startsWith("--profile-startup=")) {
+      auto logPath = arg.fromFirstOccurrenceOf("=", false, false);
+      StartupProfiler::getInstance().enable(absoluteFileFromPath(logPath));
+    } else if (arg == "--bench-exit") {
+      StartupBench::getInstance().enable();
+    }
+  }
+  initialisePhase = StartupProfiler::getInstance().beginPhase("initialise");
+
   if (args.contains("--help")) {
     std::cerr << "arguments:" << std::endl;
     std::cerr << "  --help:	Print usage help" << std::endl;
     std::cerr << "  --fakewifi:	Use fake WifiStatus" << std::endl;
+    std::cerr << "  --profile-startup[=FILE]:	Print startup phase timings, and append them"
+              << " to FILE as a JSON line" << std::endl;
+    std::cerr << "  --bench-exit:	Print startup timings and memory use as JSON once"
+              << " interactive, then quit" << std::endl;
     quit();
   }
 
+  // Put last session's frame up before constructing anything, the pages take a while.
+  // The lock screen only needs the password file, which is cheap to check.
+  {
+    StartupPhase phase("boot snapshot");
+    bootSnapshot = BootSnapshotComponent::create(LoginPage::isPasswordSet());
+  }
+  if (bootSnapshot) {
+    bootSnapshot->onFirstFrame = [this] { finishInitialise(); };
+    mainWindow = new MainWindow(getApplicationName(), bootSnapshot, false);
+    return;
+  }
+  finishInitialise();
+}
+
+void PokeLaunchApplication::finishInitialise() {
+  auto &profiler = StartupProfiler::getInstance();
+
   auto configFile = assetConfigFile("config.json");
   if (!configFile.exists()) {
-    File folder("~/.pocket-home");
-    folder.createDirectory();
-    configFile.create();
-    if(!configFile.setReadOnly(false))
-      std::cerr << "Problem creating the config file !" << std::endl;
+    StartupPhase phase("config copy");
     File configOriginal = assetFile("config.json");
     String content = configOriginal.loadFileAsString();
-    configFile.replaceWithText(content);
+    // never leaves an empty or half copied file behind to trip the restore dialog below
+    if (!ConfigWriter::writeAtomically(configFile, content))
+      std::cerr << "Problem creating the config file !" << std::endl;
   /*    std::cerr << "Missing config file: " << configFile.getFullPathName() << std::endl;
     quit();*/
   }
 
-  auto configJson = JSON::parse(configFile);
-  if (!configJson) {
+  auto &config = AppConfig::getInstance();
+  auto configResult = [&config, &configFile] {
+    StartupPhase phase("config.json parse");
+    return config.load(configFile);
+  }();
+  if (configResult.failed()) {
+    std::cerr << configResult.getErrorMessage() << std::endl;
     bool launch = AlertWindow::showOkCancelBox(AlertWindow::AlertIconType::WarningIcon,
 	"Cannot launch Pocket-Home",
 	"Home configuartion could not be read\n\
@@ -200,10 +239,19 @@ configuration automatically ?",
     }
   }
 
-  // open sound handle
+  {
+    StartupPhase phase("asset watch");
+    // the asset index was built by the first assetFile() call, keep it fresh from here on
+    AssetResolver::getInstance().startWatching();
+    // provisioning scripts and editors can change config.json under us, pick that up live
+    config.startWatching();
+  }
 
-  if(!sound())
-    DBG("Sound failed to initialize");
+  // open sound handle, configuring the device blocks for a while so it happens off to the side
+  AsyncInit::getInstance().run<bool>("sound", [this] { return sound(); }, [](const bool &ok) {
+    if (!ok)
+      DBG("Sound failed to initialize");
+  });
 
   // Populate with dummy data
   {
@@ -212,19 +260,71 @@ configuration automatically ?",
     else
       wifiStatus = &wifiStatusNM;
 
-    wifiStatus->initializeStatus();
+    {
+      StartupPhase phase("wifi status");
+      wifiStatus->initializeStatusAsync();
+    }
 
+    StartupPhase phase("bluetooth status");
     auto deviceListFile = assetFile("bluetooth.json");
     bluetoothStatus.populateFromJson(JSON::parse(deviceListFile));
   }
 
-  mainWindow = new MainWindow(getApplicationName(), configJson);
+  // connects to X and reads the client list, which needn't hold up the first frame
+  AsyncInit::getInstance().run<bool>("window tracker", [] {
+    return WindowTracker::getInstance().start();
+  });
+
+  // may move the launcher into a cgroup leaf of its own or probe systemd-run, both blocking.
+  // The instance is made here, it listens to the ProcessSupervisor on the message thread.
+  auto &appCgroups = AppCgroups::getInstance();
+  AsyncInit::getInstance().run<bool>("app cgroups", [&appCgroups] {
+    return appCgroups.init() != AppCgroups::Mode::none;
+  });
+
+  {
+    StartupPhase phase("main window");
+    auto content = new MainContentComponent(config);
+    if (mainWindow) {
+      // the window is already up showing the snapshot, swap the real content in under it
+      mainWindow->setContentOwned(content, false);
+      content->showBootSnapshot(bootSnapshot.release());
+    } else {
+      mainWindow = new MainWindow(getApplicationName(), content, true);
+    }
+  }
+  SharedImageCache::getInstance().logStats();
+  // blobs left over from old wallpapers and icon sizes, trimmed to budget off to the side
+  DiskImageCache::getInstance().pruneSoon();
+  profiler.endPhase(initialisePhase);
+
+  // closed by the first paint, see StartupProfiler::framePainted()
+  profiler.beginPhase("first frame");
 }
 
 void PokeLaunchApplication::shutdown() {
   // Add your application's shutdown code here..
 
+  // what the launcher looks like now is what the next boot shows first
+  if (mainWindow) {
+    if (auto content = dynamic_cast<MainContentComponent *>(mainWindow->getContentComponent()))
+      content->saveLauncherSnapshot(false);
+  }
+
+  // no icon deliveries to half destroyed pages
+  IconLoader::getInstance().shutdown();
+  DiskImageCache::getInstance().shutdown();
+  AsyncInit::getInstance().waitForAll();
+  AppConfig::getInstance().stopWatching();
+  WindowTracker::getInstance().stop();
+  ProcessSupervisor::getInstance().stop();
+  AppConfig::getInstance().flush();
+  LaunchTelemetry::getInstance().flush();
+
   mainWindow = nullptr; // (deletes our window)
+  bootSnapshot = nullptr;
+
+  AssetResolver::getInstance().stopWatching();
 }
 
 void PokeLaunchApplication::systemRequestedQuit() {
@@ -243,11 +343,14 @@ PageStackComponent &PokeLaunchApplication::getMainStack() {
   return *dynamic_cast<MainContentComponent *>(mainWindow->getContentComponent())->pageStack;
 }
 
-PokeLaunchApplication::MainWindow::MainWindow(String name, const var &configJson)
+PokeLaunchApplication::MainWindow::MainWindow(String name, Component *content, bool ownContent)
 : DocumentWindow(name, Colours::darkgrey, DocumentWindow::allButtons) {
   setUsingNativeTitleBar(true);
   setResizable(true, false);
-  setContentOwned(new MainContentComponent(configJson), true);
+  if (ownContent)
+    setContentOwned(content, true);
+  else
+    setContentNonOwned(content, true);
   centreWithSize(getWidth(), getHeight());
   setVisible(true);
 #if JUCE_LINUX
@@ -256,15 +359,6 @@ PokeLaunchApplication::MainWindow::MainWindow(String name, const var &configJson
 #endif
 }
 
-void PokeLaunchApplication::MainWindow::activeWindowStatusChanged() {
-  if (!isActiveWindow()) {
-    auto contentComponent = getContentComponent();
-    if (contentComponent) {
-      ((MainContentComponent*)contentComponent)->handleMainWindowInactive();
-    }
-  }
-}
-
 void PokeLaunchApplication::MainWindow::closeButtonPressed() {
   // This is called when the user tries to close this window. Here, we'll just
   // ask the app to quit when this happens, but you can change this to do
@@ -3,6 +3,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #include "MainComponent.h"
+#include "BootSnapshot.h"
 #include "WifiStatus.h"
 #include "Utils.h"
 
@@ -22,8 +23,6 @@ struct BluetoothStatus {
 PageStackComponent &getMainStack();
 WifiStatus &getWifiStatus();
 BluetoothStatus &getBluetoothStatus();
-File getConfigFile();
-var  getConfigJSON();
 
 class PokeLaunchApplication : public JUCEApplication {
 public:
@@ -61,12 +60,17 @@ public:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
 
   public:
-    MainWindow(String name, const var &configJson);
+    MainWindow(String name, Component *content, bool ownContent);
 
-    void activeWindowStatusChanged() override;
     void closeButtonPressed() override;
   };
 
 private:
+  // the rest of initialise(), run once the boot snapshot (if any) is on screen
+  void finishInitialise();
+
   ScopedPointer<MainWindow> mainWindow;
+  ScopedPointer<BootSnapshotComponent> bootSnapshot;
+  StringArray args;
+  int initialisePhase = -1;
 };
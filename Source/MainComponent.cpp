@@ -2,22 +2,31 @@
 #include "PokeLookAndFeel.h"
 #include "LauncherComponent.h"
 #include "Utils.h"
+#include "StartupProfiler.h"
+#include "StartupBench.h"
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
 
-MainContentComponent::MainContentComponent(const var &configJson)
+MainContentComponent::MainContentComponent(AppConfig &config)
 {
   lookAndFeel = new PokeLookAndFeel();
   setLookAndFeel(lookAndFeel);
 
   //Function to execute when the login button is pressed on login page
   auto function = [this] () { this->loggedIn(); };
-  lp = new LoginPage(function);
+  {
+    StartupPhase phase("login page");
+    lp = new LoginPage(function);
+  }
   LookAndFeel::setDefaultLookAndFeel(lookAndFeel);
 
   pageStack = new PageStackComponent();
+  // covering the launcher with another page, keep what it looked like for the next boot
+  pageStack->onLeavingPage = [this](Component *page) {
+    if (page == launcher) saveLauncherSnapshot();
+  };
   
   if(lp->hasPassword())
     addAndMakeVisible(lp);
@@ -25,13 +34,17 @@ MainContentComponent::MainContentComponent(const var &configJson)
     addAndMakeVisible(pageStack);  
   lp->textFocus();
   
-  launcher = new LauncherComponent(configJson);
+  {
+    StartupPhase phase("launcher");
+    launcher = new LauncherComponent(config);
+  }
   pageStack->pushPage(launcher, PageStackComponent::kTransitionNone);
 
   setSize(480, 272);
 }
 
 void MainContentComponent::loggedIn(){
+  BootSnapshot::getInstance().save(*lp, true);
   removeChildComponent(lp);
   addAndMakeVisible(pageStack);
 }
@@ -42,14 +55,39 @@ void MainContentComponent::paint(Graphics &g) {
   g.fillAll(Colours::white);
 }
 
+void MainContentComponent::paintOverChildren(Graphics &g) {
+  // runs after whichever page is showing has painted, opaque pages hide paint() above
+  StartupProfiler::getInstance().framePainted();
+  StartupBench::getInstance().framePainted(true);
+}
+
 void MainContentComponent::resized() {
   auto bounds = getLocalBounds();
   pageStack->setBounds(bounds);
   lp->setBounds(bounds);
+  if (bootSnapshot) bootSnapshot->setBounds(bounds);
+}
+
+void MainContentComponent::showBootSnapshot(BootSnapshotComponent *snapshot) {
+  bootSnapshot = snapshot;
+  if (!bootSnapshot) return;
+  addAndMakeVisible(bootSnapshot);
+  bootSnapshot->toFront(false);
+  bootSnapshot->setBounds(getLocalBounds());
+  bootSnapshot->fadeOut(300);
+}
+
+void MainContentComponent::saveLauncherSnapshot(bool inBackground) {
+  if (!launcher || lp->getParentComponent() == this) return;
+  if (launcher->pageStack->getCurrentPage() != launcher->defaultPage) return;
+  if (launcher->launchSpinner->isVisible() || launcher->focusButtonPopup->isVisible()) return;
+  BootSnapshot::getInstance().save(*launcher, false, inBackground);
 }
 
-void MainContentComponent::handleMainWindowInactive() {
-  launcher->hideLaunchSpinner();
+bool LoginPage::isPasswordSet() {
+  File passwd(String(getenv("HOME")) + "/.pocket-home/.passwd/passwd");
+  if (!passwd.existsAsFile()) return false;
+  return passwd.loadFileAsString().removeCharacters("\n") != "none";
 }
 
 bool LoginPage::hasPassword(){
@@ -72,7 +110,7 @@ bool LoginPage::hasPassword(){
 }
 
 LoginPage::LoginPage(std::function<void(void)> lambda):
-bgImage(new DrawableImage),
+bgSurface(*this, Colours::white, assetFile("login/background.png")),
 ntcIcon(new DrawableImage),
 cur_password(new TextEditor("field_password", 0x2022)),
 label_password(new Label("pass", "Password :")),
@@ -80,8 +118,6 @@ log(new TextButton("login")), hashed_password("none"),
 functiontoexecute(lambda), haspassword(false)
 {
   this->setBounds(0, 0, 480, 272);
-  Image bg = createImageFromFile(assetFile("login/background.png"));
-  bgImage->setImage(bg);
   Image ntc = createImageFromFile(assetFile("login/ntcbanner.png"));
   ntcIcon->setImage(ntc);
   log->setButtonText("Log In");
@@ -96,7 +132,6 @@ functiontoexecute(lambda), haspassword(false)
   /* Adding a listener for catching the moment return key is pressed */
   cur_password->addListener(this);
   
-  addAndMakeVisible(bgImage, 1);
   addAndMakeVisible(ntcIcon, 4);
   addAndMakeVisible(cur_password, 3);
   addAndMakeVisible(label_password, 2);
@@ -111,9 +146,8 @@ functiontoexecute(lambda), haspassword(false)
 LoginPage::~LoginPage(){}
 
 void LoginPage::resized() {
-  auto bounds = getLocalBounds();
+  bgSurface.resized();
   ntcIcon->setBounds(0, 0, 480, 130);
-  bgImage->setBounds(0, 0, bgImage->getWidth(), bgImage->getHeight());
 }
 
 void LoginPage::displayError(){
@@ -146,5 +180,5 @@ void LoginPage::textEditorReturnKeyPressed(TextEditor& te){
 }
 
 void LoginPage::paint(Graphics &g) {
-  g.fillAll(Colours::white);
+  bgSurface.paint(g);
 }
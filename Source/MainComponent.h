@@ -5,6 +5,9 @@
 #include "LauncherComponent.h"
 #include "PageStackComponent.h"
 #include "SettingsPageLogin.h"
+#include "BackgroundSurface.h"
+#include "BootSnapshot.h"
+#include "AppConfigModel.h"
 
 class MainContentComponent;
 
@@ -17,6 +20,8 @@ public:
   virtual void paint(Graphics &) override;
   virtual void buttonClicked(Button *button) override;
   virtual bool hasPassword();
+  // Whether a password is set, without needing a LoginPage.
+  static bool isPasswordSet();
   virtual void textFocus();
   virtual void textEditorReturnKeyPressed(TextEditor&) override;
   
@@ -29,7 +34,7 @@ private:
   ScopedPointer<TextButton> log;
   ScopedPointer<Label> label_password;
   String hashed_password;
-  ScopedPointer<DrawableImage> bgImage;
+  BackgroundSurface bgSurface;
   ScopedPointer<DrawableImage> ntcIcon;
   ScopedPointer<TextEditor> cur_password;
 };
@@ -41,16 +46,22 @@ public:
 
   ScopedPointer<PageStackComponent> pageStack;
 
-  MainContentComponent(const var &configJson);
+  MainContentComponent(AppConfig &config);
   ~MainContentComponent();
 
   void paint(Graphics &) override;
+  void paintOverChildren(Graphics &) override;
   void resized() override;
   void loggedIn();
-  
-  void handleMainWindowInactive();
+
+  // Takes ownership of the snapshot shown while starting up and fades it out over this.
+  void showBootSnapshot(BootSnapshotComponent *snapshot);
+  // Saves the launcher as the next boot's first frame, unless it's covered by something
+  // that won't be there next time (the lock screen, another page, the launch spinner).
+  void saveLauncherSnapshot(bool inBackground = true);
 
 private:
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainContentComponent)
   ScopedPointer<LoginPage> lp;
+  ScopedPointer<BootSnapshotComponent> bootSnapshot;
 };
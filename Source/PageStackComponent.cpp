@@ -22,6 +22,7 @@ int PageStackComponent::getDepth() const {
 void PageStackComponent::pushPage(Component *page, Transition transition) {
   auto bounds = getLocalBounds();
   if (!stack.isEmpty()) {
+    if (onLeavingPage) onLeavingPage(stack.getLast());
     transitionOut(stack.getLast(), transition, transitionDurationMillis);
   }
   stack.add(page);
@@ -30,6 +31,7 @@ void PageStackComponent::pushPage(Component *page, Transition transition) {
 
 void PageStackComponent::swapPage(Component *page, Transition transition) {
   if (!stack.isEmpty()) {
+    if (onLeavingPage) onLeavingPage(stack.getLast());
     transitionOut(stack.getLast(), transition, transitionDurationMillis);
     stack.removeLast();
   }
@@ -6,6 +6,9 @@ class PageStackComponent : public Component {
 public:
   int transitionDurationMillis = 200;
 
+  // Called with the current top page just before a push or swap takes it off screen.
+  std::function<void(Component *)> onLeavingPage;
+
   PageStackComponent();
   ~PageStackComponent();
 
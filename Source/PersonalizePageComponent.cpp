@@ -7,15 +7,11 @@ background("lab_back","Background"), icons("lab_icons","Icons management"), opt_
 opt_name("opt_name", "Name:"), opt_img("opt_img", "Icon path:"), opt_shell("opt_shell", "Command:"),
 add_btn("Add"), apply("Apply"), choose_back("back_box"), edit_back("back_field"),
 edit_name("name"), edit_icn("icn"), edit_shell("shell"),
-config(getConfigFile()),
-json(getConfigJSON()),
-/*config(assetConfigFile("config.json")),
-json(JSON::parse(config)),*/
+config(AppConfig::getInstance()),
 success("suc", "Success !"), browse("..."),
-browseicon("...")
+browseicon("..."),
+bgSurface(*this, Colour(0xffd23c6d), assetFile("settingsBackground.png"))
 {
-  bgColor = Colour(0xffd23c6d);
-  bgImage = createImageFromFile(assetFile("settingsBackground.png"));
   Font big_font(Font::getDefaultMonospacedFontName(), 25.f, 0);
   background.setFont(big_font);
   icons.setFont(big_font);
@@ -69,14 +65,16 @@ browseicon("...")
   addAndMakeVisible(backButton);
 
   updateComboBox();
+  config.addListener(this);
 }
 
 PersonalizePageComponent::~PersonalizePageComponent(){
+  config.removeListener(this);
 }
 
 void PersonalizePageComponent::updateComboBox(){
   /* Checking the current configuration */
-  String background = (json["background"]).toString();
+  String background = config.getBackground();
   bool display = false;
   if(background.length()==0);
   else if(background.length()==6 && 
@@ -96,12 +94,11 @@ void PersonalizePageComponent::updateComboBox(){
 }
 
 void PersonalizePageComponent::paint(Graphics &g){
-  auto bounds = getLocalBounds();
-  g.fillAll(bgColor);
-  g.drawImage(bgImage,bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(), 0, 0, bgImage.getWidth(), bgImage.getHeight(), false);
+  bgSurface.paint(g);
 }
 
 void PersonalizePageComponent::resized(){
+  bgSurface.resized();
   auto bounds = getLocalBounds();
   backButton->setBounds(bounds.getX(), bounds.getY(), 60, bounds.getHeight());
   
@@ -154,7 +151,7 @@ void PersonalizePageComponent::buttonClicked(Button* button){
     updateComboBox();
   }
   else if(button == &apply){
-    bool ok = updateJSON();
+    bool ok = updateConfig();
     updateFile(ok);
   }
   else if(button == &add_btn){
@@ -242,46 +239,53 @@ void PersonalizePageComponent::comboBoxChanged(ComboBox* box){
 }
 
 void PersonalizePageComponent::updateFile(bool ok){
-  DynamicObject* obj = json.getDynamicObject();
-  String s = JSON::toString(json);
-  bool write = config.replaceWithText(s);
+  bool write = config.save();
   if(write && ok){
+    // save() only queues the write, "Success !" waits for it in configWritten()
     apply.setVisible(false);
-    success.setVisible(true);
+    awaitingWrite = true;
   }
   else if(!write){
-    String message = "Error writing the configuration into the file\nCheck the permissions";
-    AlertWindow::showMessageBox(
-            AlertWindow::AlertIconType::WarningIcon,
-            "Error",
-            message);
+    showWriteError();
+  }
+}
+
+void PersonalizePageComponent::configWritten(bool ok){
+  if(!awaitingWrite) return;
+  awaitingWrite = false;
+  if(!ok){
+    apply.setVisible(true);
+    showWriteError();
+  }
+  // not if the page has been left and reset in the meantime
+  else if(!apply.isVisible()){
+    success.setVisible(true);
   }
 }
 
-bool PersonalizePageComponent::updateJSON(){
-  Array<var>* pages_arr = (json["pages"].getArray());
-  const var& pages = ((*pages_arr)[0]);
-  Array<var>* items_arr = pages["items"].getArray();
+void PersonalizePageComponent::showWriteError(){
+  String message = "Error writing the configuration into the file\nCheck the permissions";
+  AlertWindow::showMessageBoxAsync(
+          AlertWindow::AlertIconType::WarningIcon,
+          "Error",
+          message);
+}
+
+bool PersonalizePageComponent::updateConfig(){
   bool name_b = false;
   bool color_b = false;
   if(edit_name.isVisible()){
     String name = edit_name.getText();
     String path = edit_icn.getText();
     String cmmd = edit_shell.getText();
-    DynamicObject* new_icn = new DynamicObject;
-    new_icn->setProperty("name",name);
-    new_icn->setProperty("icon",path);
-    new_icn->setProperty("shell",cmmd);
-    var icn_var(new_icn);
-    items_arr->add(icn_var);
+    int id = config.addApp(name, path, cmmd);
     name_b = true;
     
     /* Adding to the grid */
-    lcomp->addIcon(name, path, cmmd);
+    lcomp->addIcon(*config.getApp(id));
   }
   if(choose_back.getSelectedId()==1){
-    DynamicObject* new_back = json.getDynamicObject();
-    new_back->setProperty("background","4D4D4D");
+    config.setBackground("4D4D4D");
     color_b = true;
     lcomp->setColorBackground("4D4D4D");
   }
@@ -290,8 +294,7 @@ bool PersonalizePageComponent::updateJSON(){
     if(value.length()!=6 || !value.containsOnly("0123456789ABCDEF"))
       edit_back.setText("Invalid color");
     else{
-      DynamicObject* new_back = json.getDynamicObject();
-      new_back->setProperty("background",value);
+      config.setBackground(value);
       color_b = true;
 
       /* Change background in LauncherComponent */
@@ -300,8 +303,7 @@ bool PersonalizePageComponent::updateJSON(){
   }
   if(choose_back.getSelectedId()==3){
     String value = edit_back.getText();
-    DynamicObject* new_back = json.getDynamicObject();
-    new_back->setProperty("background",value);
+    config.setBackground(value);
     color_b = true;
 
     /* Change background in LauncherComponent */
@@ -321,21 +323,3 @@ void PersonalizePageComponent::resetApplySuccess(){
   edit_shell.setText("");
   apply.setVisible(true);
 }
-
-void PersonalizePageComponent::deleteIcon(String name, String shell){
-  Array<var>* pages_arr = (json["pages"].getArray());
-  const var& pages = ((*pages_arr)[0]);
-  Array<var>* items_arr = pages["items"].getArray();
-  
-  //Searching for the element in the Array
-  for(int i = 0; i < items_arr->size(); i++){
-    const var& elt = (*items_arr)[i];
-    if(elt["name"] == name && elt["shell"] == shell){
-      items_arr->remove(i);
-      break;
-    }
-  }
-  /*False because we don't want to change the icons in the persoPage
-    as it's even not shown */
-  updateFile(false);
-}
\ No newline at end of file
@@ -3,11 +3,14 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Utils.h"
+#include "BackgroundSurface.h"
 #include "Main.h"
+#include "AppConfigModel.h"
 class LauncherComponent;
 
 /* Adding personnalization page */
-class PersonalizePageComponent : public Component, private Button::Listener, private ComboBox::Listener {
+class PersonalizePageComponent : public Component, private Button::Listener, private ComboBox::Listener,
+                                 private AppConfig::Listener {
 public:
   PersonalizePageComponent(LauncherComponent*);
   ~PersonalizePageComponent();
@@ -18,20 +21,20 @@ public:
   void comboBoxChanged(ComboBox*) override;
   void showAddComponents(bool);
   void resetApplySuccess();
-  void deleteIcon(String, String);
   
 private:
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PersonalizePageComponent)
   
   void updateFile(bool);
-  bool updateJSON();
+  void configWritten(bool ok) override;
+  void showWriteError();
+  bool updateConfig();
   void updateComboBox();
   
   ScopedPointer<ImageButton> backButton;
-  Colour bgColor;
-  Image bgImage;
-  File config;
-  var json;
+  AppConfig &config;
+  // applied, but not written to config.json yet
+  bool awaitingWrite = false;
   
   /* Launcher component */
   LauncherComponent* lcomp;
@@ -58,6 +61,8 @@ private:
   TextEditor edit_name;
   TextEditor edit_icn;
   TextEditor edit_shell;
+
+  BackgroundSurface bgSurface;
 };
 
 #endif
\ No newline at end of file
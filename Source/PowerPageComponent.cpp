@@ -6,24 +6,12 @@
 
 #include <numeric>
 
-void PowerSpinnerTimer::timerCallback() {
-    if (powerComponent) {
-        auto lsp = powerComponent->powerSpinner.get();
-        const auto& lspImg = powerComponent->launchSpinnerImages;
-        i++;
-        if (i == lspImg.size()) { i = 0; }
-      
-        lsp->setImage(lspImg[i]);
-        
-    }
-}
-
 unsigned char PowerPageComponent::rev_number = 9;
 unsigned char PowerPageComponent::bug_number = 0;
 
-PowerPageComponent::PowerPageComponent() {
-  bgColor = Colours::black;
-  bgImage = createImageFromFile(assetFile("powerMenuBackground.png"));
+PowerPageComponent::PowerPageComponent() :
+  bgSurface(*this, Colours::black, assetFile("powerMenuBackground.png"))
+{
   mainPage = new Component();
   addAndMakeVisible(mainPage);
   mainPage->toBack();
@@ -62,14 +50,8 @@ PowerPageComponent::PowerPageComponent() {
     felButton->addListener(this);
     addAndMakeVisible(felButton);
   
-    powerSpinnerTimer.powerComponent = this;
-    Array<String> spinnerImgPaths{"wait0.png","wait1.png","wait2.png","wait3.png","wait4.png","wait5.png","wait6.png","wait7.png"};
-    for(auto& path : spinnerImgPaths) {
-        auto image = createImageFromFile(assetFile(path));
-        launchSpinnerImages.add(image);
-    }
-    powerSpinner = new ImageComponent();
-    powerSpinner->setImage(launchSpinnerImages[0]);
+    // one frame a second
+    powerSpinner = new SpinnerComponent("Power Spinner", "wait", 2);
     addChildComponent(powerSpinner);
   
   buildName = "Build: ";
@@ -128,12 +110,11 @@ void PowerPageComponent::hideLockscreen(){
 }
 
 void PowerPageComponent::paint(Graphics &g) {
-    auto bounds = getLocalBounds();
-    g.fillAll(bgColor);
-    g.drawImage(bgImage,bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(), 0, 0, bgImage.getWidth(), bgImage.getHeight(), false);
+    bgSurface.paint(g);
 }
 
 void PowerPageComponent::resized() {
+  bgSurface.resized();
   
   auto bounds = getLocalBounds();
    powerSpinner->setBounds(0, 0, bounds.getWidth(), bounds.getHeight());
@@ -198,7 +179,6 @@ void PowerPageComponent::showPowerSpinner() {
     rebootButton->setVisible(false);
     felButton->setVisible(false);
     powerSpinner->setVisible(true);
-    powerSpinnerTimer.startTimer(1*1000);
 }
 
 void PowerPageComponent::buttonStateChanged(Button *btn) {
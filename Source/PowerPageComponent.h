@@ -5,18 +5,12 @@
 #include "PowerPageComponent.h"
 #include "SwitchComponent.h"
 #include "PageStackComponent.h"
+#include "SpinnerComponent.h"
+#include "BackgroundSurface.h"
 
 class PowerPageComponent;
 class LoginPage;
 
-class PowerSpinnerTimer : public Timer {
-public:
-    PowerSpinnerTimer() {};
-    void timerCallback() override;
-    PowerPageComponent* powerComponent;
-    int i = 0;
-};
-
 class PowerPageComponent : public Component, private Button::Listener {
 public:
 
@@ -30,11 +24,9 @@ public:
     ScopedPointer<Label> buildNameLabel;
     ScopedPointer<Label> rev;
     ScopedPointer<Component> mainPage;
-    ScopedPointer<ImageComponent> powerSpinner;
+    ScopedPointer<SpinnerComponent> powerSpinner;
     ScopedPointer<AlertWindow> updateWindow;
     
-    PowerSpinnerTimer powerSpinnerTimer;
-    Array<Image> launchSpinnerImages;
     HashMap<String, Component *> pagesByName;
   
   String buildName;
@@ -58,8 +50,7 @@ public:
   
 private:
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PowerPageComponent)
-  Colour bgColor;
-  Image bgImage;
+  BackgroundSurface bgSurface;
   String bgImagePath;
   ChildProcess child;
 
@@ -123,9 +123,9 @@ void PowerFelCategoryItemComponent::enablementChanged() {
     updateButtonText();
 }
 
-PowerFelPageComponent::PowerFelPageComponent() {
-    bgColor = Colours::black;
-    bgImage = "powerMenuBackground.png";
+PowerFelPageComponent::PowerFelPageComponent() :
+    bgSurface(*this, Colours::black, assetFile("powerMenuBackground.png"))
+{
     mainPage = new Component();
     addAndMakeVisible(mainPage);
     mainPage->toBack();
@@ -147,10 +147,7 @@ PowerFelPageComponent::PowerFelPageComponent() {
 PowerFelPageComponent::~PowerFelPageComponent() {}
 
 void PowerFelPageComponent::paint(Graphics &g) {
-    auto bounds = getLocalBounds();
-    g.fillAll(bgColor);
-    auto image = createImageFromFile(assetFile(bgImage));
-    g.drawImage(image,bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(), 0, 0, image.getWidth(), image.getHeight(), false);
+    bgSurface.paint(g);
   
     g.setColour (Colours::white);
     g.setFont (22);
@@ -161,7 +158,7 @@ void PowerFelPageComponent::paint(Graphics &g) {
 }
 
 void PowerFelPageComponent::resized() {
-    
+    bgSurface.resized();
     auto bounds = getLocalBounds();
     auto pageBounds = Rectangle<int>(120, 0, bounds.getWidth() - 120, bounds.getHeight());
   
@@ -3,6 +3,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #include "SwitchComponent.h"
+#include "BackgroundSurface.h"
 
 class PowerFelPageComponent;
 
@@ -71,7 +72,6 @@ public:
     
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PowerFelPageComponent)
-    Colour bgColor;
-    String bgImage;
+    BackgroundSurface bgSurface;
     ChildProcess child;
 };
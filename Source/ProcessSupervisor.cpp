@@ -0,0 +1,251 @@
+#include "ProcessSupervisor.h"
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434 // the same on every architecture
+#endif
+
+namespace {
+
+// the supervisor's wake pipe, for the SIGCHLD fallback
+int sigchldWakeFd = -1;
+
+void sigchldHandler(int) {
+  const int savedErrno = errno;
+  const char byte = 0;
+  if (sigchldWakeFd >= 0 && write(sigchldWakeFd, &byte, 1) < 0) {
+    // the pipe is full, so the thread is due to wake up anyway
+  }
+  errno = savedErrno;
+}
+
+void installSigchldHandler(int wakeFd) {
+  static bool installed = false;
+  if (installed) return;
+  installed = true;
+  sigchldWakeFd = wakeFd;
+
+  struct sigaction action;
+  zerostruct(action);
+  action.sa_handler = sigchldHandler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  sigaction(SIGCHLD, &action, nullptr);
+}
+
+}
+
+class ProcessSupervisor::ExitMessage : public CallbackMessage {
+public:
+  ExitMessage(const ExitInfo &info) : info(info) {}
+
+  void messageCallback() override {
+    ProcessSupervisor::getInstance().listeners.call(&Listener::processExited, info);
+  }
+
+private:
+  ExitInfo info;
+};
+
+ProcessSupervisor &ProcessSupervisor::getInstance() {
+  static ProcessSupervisor instance;
+  return instance;
+}
+
+ProcessSupervisor::ProcessSupervisor() : Thread("ProcessSupervisor") {}
+
+ProcessSupervisor::~ProcessSupervisor() {
+  stop();
+}
+
+bool ProcessSupervisor::ensureStarted() {
+  if (wakePipe[0] < 0) {
+    if (pipe2(wakePipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+      wakePipe[0] = wakePipe[1] = -1;
+      return false;
+    }
+    // Without pidfds only SIGCHLD tells us about exits, and the handler has to be in place
+    // before the first fork, or a child that exits right away is never noticed.
+    const int probe = (int)syscall(SYS_pidfd_open, getpid(), 0);
+    if (probe >= 0) close(probe);
+    else installSigchldHandler(wakePipe[1]);
+  }
+  if (!isThreadRunning()) startThread(3);
+  return true;
+}
+
+void ProcessSupervisor::wake() {
+  const char byte = 0;
+  if (wakePipe[1] >= 0 && write(wakePipe[1], &byte, 1) < 0) {
+    // already has a wakeup pending
+  }
+}
+
+StringArray ProcessSupervisor::splitCommand(const String &command) {
+  StringArray args;
+  args.addTokens(command, true);
+  args.trim();
+  args.removeEmptyStrings();
+  // quotes group an argument, they aren't part of it
+  for (auto &arg : args) arg = arg.unquoted();
+  return args;
+}
+
+int ProcessSupervisor::launch(const String &command) {
+  return launch(splitCommand(command));
+}
+
+int ProcessSupervisor::launch(const StringArray &args, const File &cgroup) {
+  if (args.isEmpty()) return -1;
+
+  const ScopedLock sl(lock);
+  if (!ensureStarted()) return -1;
+
+  // everything the child needs is prepared before forking
+  std::vector<const char *> argv;
+  for (const auto &arg : args) argv.push_back(arg.toRawUTF8());
+  argv.push_back(nullptr);
+  const String procsPath =
+      cgroup == File::nonexistent ? String() : cgroup.getChildFile("cgroup.procs").getFullPathName();
+  const char *procs = procsPath.isEmpty() ? nullptr : procsPath.toRawUTF8();
+
+  const int pid = fork();
+  if (pid < 0) return -1;
+  if (pid == 0) {
+    // the launcher's signal setup isn't the app's business
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+    signal(SIGCHLD, SIG_DFL);
+    if (procs) {
+      // "0" is whoever writes it
+      const int fd = open(procs, O_WRONLY | O_CLOEXEC);
+      if (fd >= 0 && write(fd, "0", 1) < 0) {
+        // the app still runs, just not confined
+      }
+      if (fd >= 0) close(fd);
+    }
+    execvp(argv[0], const_cast<char *const *>(argv.data()));
+    _exit(127);
+  }
+
+  Child child;
+  child.pid = pid;
+  child.pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+  child.startMs = Time::getMillisecondCounterHiRes();
+  // pidfd_open can still fail here, out of descriptors say, then SIGCHLD has to do. An exit
+  // before the handler is in place is caught on the wake below.
+  if (child.pidfd < 0) installSigchldHandler(wakePipe[1]);
+  else fcntl(child.pidfd, F_SETFD, FD_CLOEXEC);
+  children.add(child);
+  wake();
+  return pid;
+}
+
+bool ProcessSupervisor::isRunning(int pid) const {
+  const ScopedLock sl(lock);
+  for (const auto &child : children) {
+    if (child.pid == pid) return true;
+  }
+  return false;
+}
+
+int ProcessSupervisor::getNumRunning() const {
+  const ScopedLock sl(lock);
+  return children.size();
+}
+
+void ProcessSupervisor::addListener(Listener *listener) {
+  listeners.add(listener);
+}
+
+void ProcessSupervisor::removeListener(Listener *listener) {
+  listeners.remove(listener);
+}
+
+void ProcessSupervisor::stop() {
+  signalThreadShouldExit();
+  wake();
+  stopThread(1000);
+
+  const ScopedLock sl(lock);
+  for (const auto &child : children) {
+    if (child.pidfd >= 0) close(child.pidfd);
+  }
+  children.clear();
+}
+
+void ProcessSupervisor::reapExited(const Array<int> &pids) {
+  for (auto pid : pids) {
+    int status = 0;
+    if (waitpid(pid, &status, WNOHANG) != pid) continue;
+
+    ExitInfo info;
+    info.pid = pid;
+    info.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    info.signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    {
+      const ScopedLock sl(lock);
+      for (int i = 0; i < children.size(); ++i) {
+        const auto child = children.getReference(i);
+        if (child.pid != pid) continue;
+        info.lifetime = RelativeTime::milliseconds(
+            (int64)(Time::getMillisecondCounterHiRes() - child.startMs));
+        if (child.pidfd >= 0) close(child.pidfd);
+        children.remove(i);
+        break;
+      }
+    }
+    DBG("ProcessSupervisor: " << pid << " exited with " << info.exitCode << ", signal "
+        << info.signal << ", after " << info.lifetime.getDescription());
+    (new ExitMessage(info))->post();
+  }
+}
+
+void ProcessSupervisor::run() {
+  std::vector<struct pollfd> fds;
+  // the pid behind each fds entry, the wake pipe's is 0
+  Array<int> fdPids;
+  while (!threadShouldExit()) {
+    fds.clear();
+    fdPids.clearQuick();
+    fds.push_back({ wakePipe[0], POLLIN, 0 });
+    fdPids.add(0);
+    {
+      const ScopedLock sl(lock);
+      for (const auto &child : children) {
+        if (child.pidfd < 0) continue;
+        fds.push_back({ child.pidfd, POLLIN, 0 });
+        fdPids.add(child.pid);
+      }
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) break;
+    if (threadShouldExit()) break;
+
+    Array<int> exited;
+    for (size_t i = 1; i < fds.size(); ++i) {
+      if (fds[i].revents & (POLLIN | POLLHUP)) exited.add(fdPids[(int)i]);
+    }
+    if (fds[0].revents & POLLIN) {
+      char buffer[64];
+      while (read(wakePipe[0], buffer, sizeof(buffer)) > 0) {}
+      // A SIGCHLD doesn't say whose, so try every child without a pidfd. They're read now,
+      // after draining, rather than before poll(): a child launched and exited while we
+      // slept is in the list, and any SIGCHLD from here on wakes us again.
+      const ScopedLock sl(lock);
+      for (const auto &child : children) {
+        if (child.pidfd < 0) exited.add(child.pid);
+      }
+    }
+    reapExited(exited);
+  }
+}
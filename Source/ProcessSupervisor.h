@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Starts apps and reaps them the moment they exit, without polling.
+// A supervisor thread sleeps in poll() on a pidfd per child (Linux 5.3 and later). On older
+// kernels, such as the CHIP's, a SIGCHLD handler wakes it through a pipe instead; it then
+// only reaps the pids it started, so ChildProcess and system() keep working elsewhere.
+// Listeners hear about every exit on the message thread, with its status and lifetime.
+class ProcessSupervisor : private Thread {
+public:
+  struct ExitInfo {
+    int pid;
+    // the exit code if it exited, -1 if it was killed by a signal
+    int exitCode;
+    // the signal that killed it, 0 if it exited
+    int signal;
+    RelativeTime lifetime;
+  };
+
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    virtual void processExited(const ExitInfo &info) = 0;
+  };
+
+  static ProcessSupervisor &getInstance();
+
+  // Runs the command, split into arguments like ChildProcess::start() does (no shell),
+  // except that quotes around an argument are removed.
+  // Returns the pid, or -1 if it couldn't be started.
+  int launch(const String &command);
+  // Runs args[0] with the arguments as given. With a cgroup (v2) directory, the child moves
+  // itself into it before exec, so the app and everything it forks never run outside it.
+  int launch(const StringArray &args, const File &cgroup = File::nonexistent);
+  // The arguments launch(command) runs.
+  static StringArray splitCommand(const String &command);
+  bool isRunning(int pid) const;
+  int getNumRunning() const;
+
+  // Message thread only.
+  void addListener(Listener *listener);
+  void removeListener(Listener *listener);
+
+  // Stops watching. Children still running are left alone, but no longer reaped.
+  void stop();
+
+private:
+  ProcessSupervisor();
+  ~ProcessSupervisor();
+
+  class ExitMessage;
+
+  struct Child {
+    int pid;
+    int pidfd; // -1 on kernels without pidfd_open
+    double startMs;
+  };
+
+  bool ensureStarted();
+  void wake();
+  void run() override;
+  void reapExited(const Array<int> &pids);
+
+  CriticalSection lock;
+  Array<Child> children;
+  // written to wake the thread: a new child to watch, SIGCHLD, or stop()
+  int wakePipe[2] = { -1, -1 };
+
+  ListenerList<Listener> listeners;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessSupervisor)
+};
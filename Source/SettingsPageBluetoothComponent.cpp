@@ -71,7 +71,7 @@ SettingsPageBluetoothComponent::SettingsPageBluetoothComponent() {
   connectionPage->addAndMakeVisible(connectionButton);
 
   //icons.checkIcon = Drawable::createFromImageData(BinaryData::check_png, BinaryData::check_pngSize);
-  icons.arrowIcon = Drawable::createFromImageFile(assetFile("backIcon.png"));
+  icons.arrowIcon = createDrawableFromFile(assetFile("backIcon.png"));
   auto xf = AffineTransform::identity.rotated(M_PI);
   icons.arrowIcon->setTransform(xf);
 }
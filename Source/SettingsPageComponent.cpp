@@ -1,10 +1,51 @@
 #include "SettingsPageComponent.h"
 #include "Main.h"
+#include "StartupProfiler.h"
 #include "Utils.h"
 #include "PokeLookAndFeel.h"
+#include "AsyncInit.h"
 
 #include <numeric>
 
+// Current backlight level, -1 when it can't be read.
+static int readScreenBrightness() {
+  int brightness = -1;
+  #if JUCE_LINUX
+    ChildProcess child;
+    if(child.start("cat /sys/class/backlight/backlight/brightness")) {
+      String result{child.readAllProcessOutput()};
+      brightness = result.getIntValue();
+    }
+  #endif
+  return brightness;
+}
+
+// Current amplifier volume in percent, -1 when it can't be read.
+static int readSoundVolume() {
+  int volume = -1;
+  #if JUCE_LINUX
+    ChildProcess child;
+    StringArray cmd{ "amixer","sget","Power Amplifier" };
+    if(child.start(cmd)) {
+      const String result (child.readAllProcessOutput());
+      int resultIndex = result.indexOf("[")+1;
+      child.waitForProcessToFinish (5 * 1000);
+      char buff[4];
+      for (int i = 0; i<4; i++) {
+        char c = result[resultIndex+i];
+        if( c >= '0' && c <= '9' ) {
+          buff[i]=c;
+        } else {
+          buff[i]=(char)0;
+        }
+      }
+      String newVol = String(buff);
+      volume = newVol.getIntValue();
+    }
+  #endif
+  return volume;
+}
+
 void SettingsBrightnessTimer::timerCallback() {
   if (settingsPage) {
     settingsPage->setScreenBrightness();
@@ -97,13 +138,16 @@ WifiCategoryItemComponent::WifiCategoryItemComponent() :
   spinner(new WifiSpinner("SettingsWifiSpinner"))
 {
   iconDrawable =
-      Drawable::createFromImageFile(assetFile("wifiIcon.png"));
+      createDrawableFromFile(assetFile("wifiIcon.png"));
   icon->setImages(iconDrawable);
   bool isEnabled = getWifiStatus().isEnabled();
   toggle->setToggleState(isEnabled, NotificationType::dontSendNotification);
   button->setEnabled(isEnabled);
   addChildComponent(spinner);
   updateButtonText();
+  // still waiting for NetworkManager, busy until the status listener hears back
+  if (!getWifiStatus().isInitialized())
+    disableWifiActions();
 }
 
 void WifiCategoryItemComponent::resized() {
@@ -181,7 +225,7 @@ void WifiCategoryItemComponent::updateButtonText() {
 
 BluetoothCategoryItemComponent::BluetoothCategoryItemComponent()
 : SettingsCategoryItemComponent("bluetooth") {
-  iconDrawable = Drawable::createFromImageFile(assetFile("bluetoothIcon.png"));
+  iconDrawable = createDrawableFromFile(assetFile("bluetoothIcon.png"));
   icon->setImages(iconDrawable);
   updateButtonText();
 }
@@ -210,68 +254,59 @@ void BluetoothCategoryItemComponent::updateButtonText() {
 }
 
 
-SettingsPageComponent::SettingsPageComponent(LauncherComponent* lc) {
-  bgColor = Colour(0xffd23c6d);
-  bgImage = createImageFromFile(assetFile("settingsBackground.png"));
+SettingsPageComponent::SettingsPageComponent(LauncherComponent* lc) :
+  bgSurface(*this, Colour(0xffd23c6d), assetFile("settingsBackground.png")),
+  launcherComponent(lc)
+{
   mainPage = new Component();
   addAndMakeVisible(mainPage);
   mainPage->toBack();
-  ChildProcess child{};
 
   /* Adding the personalize button */
-  advancedPage = new AdvancedSettingsPage(lc);
   advanced = new TextButton("Advanced Settings");
   advanced->addListener(this);
   addAndMakeVisible(advanced);
   
   brightness = 8;
-  #if JUCE_LINUX
-     // Get initial brightness value
-     if(child.start("cat /sys/class/backlight/backlight/brightness")) {
-    	String result{child.readAllProcessOutput()};
-	brightness = result.getIntValue();
-     };
-  #endif
-
-
   volume = 90;
-  
-  #if JUCE_LINUX
-    // Get initial volume value
-    StringArray cmd{ "amixer","sget","Power Amplifier" };
-    if(child.start(cmd)) {
-      const String result (child.readAllProcessOutput());
-      int resultIndex = result.indexOf("[")+1;
-      child.waitForProcessToFinish (5 * 1000);
-      char buff[4];
-      for (int i = 0; i<4; i++) {
-	      char c = result[resultIndex+i];
-	      if( c >= '0' && c <= '9' ) {
-		       buff[i]=c;
-      	} else {
-		     buff[i]=(char)0;
-      	}
-      }
-      String newVol = String(buff);
-      volume = newVol.getIntValue();
-    }
-  #endif
 
-  ScopedPointer<Drawable> brightLo = Drawable::createFromImageFile(assetFile("brightnessIconLo.png"));
-  ScopedPointer<Drawable> brightHi = Drawable::createFromImageFile(assetFile("brightnessIconHi.png"));
+  ScopedPointer<Drawable> brightLo = createDrawableFromFile(assetFile("brightnessIconLo.png"));
+  ScopedPointer<Drawable> brightHi = createDrawableFromFile(assetFile("brightnessIconHi.png"));
   screenBrightnessSlider =
       ScopedPointer<IconSliderComponent>(new IconSliderComponent(*brightLo, *brightHi));
   screenBrightnessSlider->addListener(this);
   screenBrightnessSlider->slider->setValue(1+(brightness-0.09)*10);
 
   ScopedPointer<Drawable> volLo =
-      Drawable::createFromImageFile(assetFile("volumeIconLo.png"));
+      createDrawableFromFile(assetFile("volumeIconLo.png"));
   ScopedPointer<Drawable> volHi =
-      Drawable::createFromImageFile(assetFile("volumeIconHi.png"));
+      createDrawableFromFile(assetFile("volumeIconHi.png"));
   volumeSlider = ScopedPointer<IconSliderComponent>(new IconSliderComponent(*volLo, *volHi));
   volumeSlider->addListener(this);
   volumeSlider->slider->setValue(volume);
 
+  // Reading the current levels means waiting on cat and amixer. The sliders stay disabled
+  // until they're known, rather than showing the defaults above as if they were real.
+  screenBrightnessSlider->setEnabled(false);
+  volumeSlider->setEnabled(false);
+  Component::SafePointer<SettingsPageComponent> page(this);
+  AsyncInit::getInstance().run<int>("brightness", readScreenBrightness, [page](const int &level) {
+    if (!page) return;
+    if (level >= 0) {
+      page->brightness = level;
+      page->screenBrightnessSlider->slider->setValue(1+(level-0.09)*10);
+    }
+    page->screenBrightnessSlider->setEnabled(true);
+  });
+  AsyncInit::getInstance().run<int>("volume", readSoundVolume, [page](const int &level) {
+    if (!page) return;
+    if (level >= 0) {
+      page->volume = level;
+      page->volumeSlider->slider->setValue(level);
+    }
+    page->volumeSlider->setEnabled(true);
+  });
+
   // create back button
   backButton = createImageButton(
                                  "Back", createImageFromFile(assetFile("backIcon.png")));
@@ -287,22 +322,24 @@ SettingsPageComponent::SettingsPageComponent(LauncherComponent* lc) {
   addAndMakeVisible(screenBrightnessSlider);
   addAndMakeVisible(volumeSlider);
 
-  wifiPage = new SettingsPageWifiComponent();
+  wifiPage = createTimed<SettingsPageWifiComponent>("wifi page");
 }
 
 SettingsPageComponent::~SettingsPageComponent() {}
 
-void SettingsPageComponent::deleteIcon(String name, String shell){
-  advancedPage->deleteIcon(name, shell);
+AdvancedSettingsPage *SettingsPageComponent::getAdvancedPage() {
+  if (!advancedPage) {
+    advancedPage = createTimed<AdvancedSettingsPage>("advanced settings page", launcherComponent);
+  }
+  return advancedPage;
 }
 
 void SettingsPageComponent::paint(Graphics &g) {
-    auto bounds = getLocalBounds();
-    g.fillAll(bgColor);
-    g.drawImage(bgImage,bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(), 0, 0, bgImage.getWidth(), bgImage.getHeight(), false);
+    bgSurface.paint(g);
 }
 
 void SettingsPageComponent::resized() {
+  bgSurface.resized();
   auto bounds = getLocalBounds();
   int numRows = 4;
   double rowProp = 0.6/numRows;
@@ -341,7 +378,7 @@ void SettingsPageComponent::buttonClicked(Button *button) {
     wifiPage->updateAccessPoints();
     getMainStack().pushPage(wifiPage, PageStackComponent::kTransitionTranslateHorizontal);
   } else if (button == advanced) {
-    getMainStack().pushPage(advancedPage, PageStackComponent::kTransitionTranslateHorizontal);
+    getMainStack().pushPage(getAdvancedPage(), PageStackComponent::kTransitionTranslateHorizontal);
   }
 }
 
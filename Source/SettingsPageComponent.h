@@ -10,6 +10,7 @@
 #include "WifiStatus.h"
 #include "SettingsPageLogin.h"
 #include "AdvancedSettingsPage.h"
+#include "BackgroundSurface.h"
 
 class SettingsPageComponent;
 
@@ -114,7 +115,8 @@ public:
   /* Advanced Settings */
   ScopedPointer<TextButton> advanced;
   ScopedPointer<AdvancedSettingsPage> advancedPage;
-  void deleteIcon(String, String);
+  // built the first time it's needed, it builds four more pages of its own
+  AdvancedSettingsPage *getAdvancedPage();
   /*******************/
   
   ScopedPointer<SettingsPageWifiComponent> wifiPage;
@@ -141,8 +143,8 @@ public:
   
 private:
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SettingsPageComponent)
-  Colour bgColor;
-  Image bgImage;
+  BackgroundSurface bgSurface;
+  LauncherComponent *launcherComponent;
   SettingsBrightnessTimer brightnessSliderTimer;
   SettingsVolumeTimer volumeSliderTimer;
   ChildProcess child;
@@ -4,47 +4,19 @@
 #include "Utils.h"
 
 WifiSpinner::WifiSpinner(const String& componentName) :
-  ImageComponent(componentName)
+  SpinnerComponent(componentName, "spinner")
 {
-  const Array<String> spinnerImgPaths{
-    "spinner0.png","spinner1.png","spinner2.png","spinner3.png",
-    "spinner4.png","spinner5.png","spinner6.png","spinner7.png"};
-
-  for(auto& path : spinnerImgPaths) {
-    auto image = createImageFromFile(assetFile(path));
-    images.add(image);
-  }
-  
-  const auto& startImg = images[0];
-  setImage(startImg);
+  const auto& startImg = getImage();
   setSize(startImg.getWidth(), startImg.getHeight());
-  
-  timer.spinner = this;
-}
-
-WifiSpinner::~WifiSpinner() {
-  timer.stopTimer();
-  timer.spinner = nullptr;
 }
 
+// the SpinnerAnimator picks us up while we're visible
 void WifiSpinner::hide() {
   setVisible(false);
-  timer.stopTimer();
 }
 
 void WifiSpinner::show() {
   setVisible(true);
-  timer.startTimer(500);
-}
-
-void WifiSpinner::nextImage() {
-  i++;
-  if (i == images.size()) { i = 0; }
-  setImage(images[i]);
-}
-
-void WifiSpinnerTimer::timerCallback() {
-  spinner->nextImage();
 }
 
 WifiAccessPointListItem::WifiAccessPointListItem(WifiAccessPoint *ap, WifiIcons *icons)
@@ -93,32 +65,30 @@ int WifiAccessPointListItem::wifiSignalStrengthToIdx(int strength) {
 
 SettingsPageWifiComponent::SettingsPageWifiComponent() :
   nextPageBtn(createImageButton("NextAppsPage",
-                                ImageFileFormat::loadFrom(assetFile("pageDownIcon.png")))),
+                                createImageFromFile(assetFile("pageDownIcon.png")))),
   prevPageBtn(createImageButton("PrevAppsPage",
-                                ImageFileFormat::loadFrom(assetFile("pageUpIcon.png"))))
+                                createImageFromFile(assetFile("pageUpIcon.png")))),
+  bgSurface(*this, Colour(PokeLookAndFeel::chipPurple), assetFile("settingsBackground.png"))
 {
-  bgColor = Colour(PokeLookAndFeel::chipPurple);
-  bgImage = createImageFromFile(assetFile("settingsBackground.png"));
-  
   pageStack = new PageStackComponent();
   addAndMakeVisible(pageStack);
 
   wifiIconComponent = new ImageComponent("WiFi Icon");
   wifiIconComponent->setImage(
-      ImageFileFormat::loadFrom(assetFile("wifiIcon.png")));
+      createImageFromFile(assetFile("wifiIcon.png")));
   addAndMakeVisible(wifiIconComponent);
 
   icons = new WifiIcons();
 
-  icons->lockIcon = Drawable::createFromImageFile(assetFile("lock.png"));
+  icons->lockIcon = createDrawableFromFile(assetFile("lock.png"));
 
   icons->wifiStrength = OwnedArray<Drawable>();
-  icons->wifiStrength.set(0, Drawable::createFromImageFile(assetFile("wifiStrength0.png")));
-  icons->wifiStrength.set(1, Drawable::createFromImageFile(assetFile("wifiStrength1.png")));
-  icons->wifiStrength.set(2, Drawable::createFromImageFile(assetFile("wifiStrength2.png")));
-  icons->wifiStrength.set(3, Drawable::createFromImageFile(assetFile("wifiStrength3.png")));
+  icons->wifiStrength.set(0, createDrawableFromFile(assetFile("wifiStrength0.png")));
+  icons->wifiStrength.set(1, createDrawableFromFile(assetFile("wifiStrength1.png")));
+  icons->wifiStrength.set(2, createDrawableFromFile(assetFile("wifiStrength2.png")));
+  icons->wifiStrength.set(3, createDrawableFromFile(assetFile("wifiStrength3.png")));
   
-  icons->arrowIcon = Drawable::createFromImageFile(assetFile("backIcon.png"));
+  icons->arrowIcon = createDrawableFromFile(assetFile("backIcon.png"));
   auto xf = AffineTransform::identity.rotated(M_PI);
   icons->arrowIcon->setTransform(xf);
 
@@ -172,12 +142,11 @@ SettingsPageWifiComponent::SettingsPageWifiComponent() :
 SettingsPageWifiComponent::~SettingsPageWifiComponent() {}
 
 void SettingsPageWifiComponent::paint(Graphics &g) {
-    auto bounds = getLocalBounds();
-    g.fillAll(bgColor);
-    g.drawImage(bgImage,bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(), 0, 0, bgImage.getWidth(), bgImage.getHeight(), false);
+    bgSurface.paint(g);
 }
 
 void SettingsPageWifiComponent::resized() {
+  bgSurface.resized();
   auto b = getLocalBounds();
   auto pb = Rectangle<int>(60, 0, b.getWidth() - 120, b.getHeight());
 
@@ -6,34 +6,20 @@
 #include "PageStackComponent.h"
 #include "Grid.h"
 #include "Main.h"
+#include "SpinnerComponent.h"
+#include "BackgroundSurface.h"
 
 class SettingsPageWifiComponent;
-class WifiSpinnerTimer;
 class WifiSpinner;
 
-class WifiSpinnerTimer : public Timer {
-public:
-  void timerCallback() override;
-  
-  WifiSpinner* spinner;
-};
-
-
-class WifiSpinner : public ImageComponent {
+class WifiSpinner : public SpinnerComponent {
 public:
   WifiSpinner(const String& componentName = String::empty);
-  ~WifiSpinner();
   
   void hide();
   void show();
-  void nextImage();
   
 private:
-  Array<Image> images;
-  WifiSpinnerTimer timer;
-  
-  int i = 0;
-  
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WifiSpinner)
 };
 
@@ -105,8 +91,7 @@ public:
   void handleWifiBusy() override;
 
 private:
-  Colour bgColor;
-  Image bgImage;
+  BackgroundSurface bgSurface;
   
   bool init = false;
   
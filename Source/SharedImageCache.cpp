@@ -0,0 +1,167 @@
+#include "SharedImageCache.h"
+#include "DiskImageCache.h"
+#include "ImageScaling.h"
+
+SharedImageCache &SharedImageCache::getInstance() {
+  static SharedImageCache instance;
+  return instance;
+}
+
+SharedImageCache::SharedImageCache() {}
+
+String SharedImageCache::makeKey(const File &file, int width, int height, bool fit) {
+  return file.getFullPathName() + (fit ? "@fit:" : "@") + String(width) + "x" + String(height);
+}
+
+int64 SharedImageCache::getImageBytes(const Image &image) {
+  if (!image.isValid()) return 0;
+  const int pixelBytes = image.isARGB() ? 4 : (image.isRGB() ? 3 : 1);
+  return (int64)image.getWidth() * image.getHeight() * pixelBytes;
+}
+
+const Drawable *SharedImageCache::getSvgDrawable(const File &file) {
+  const ScopedLock sl(svgLock);
+  const auto path = file.getFullPathName();
+  const auto modified = file.getLastModificationTime();
+  if (svgEntriesByPath.contains(path)) {
+    auto entry = svgEntriesByPath[path];
+    if (entry->modified == modified) return entry->drawable;
+  }
+
+  ScopedPointer<XmlElement> svgElement = XmlDocument::parse(file);
+  if (!svgElement) return nullptr;
+  ScopedPointer<Drawable> drawable = Drawable::createFromSVG(*svgElement);
+  if (!drawable) return nullptr;
+
+  if (!svgEntriesByPath.contains(path)) {
+    svgEntries.add(new SvgEntry());
+    svgEntriesByPath.set(path, svgEntries.getLast());
+  }
+  auto entry = svgEntriesByPath[path];
+  entry->modified = modified;
+  entry->drawable = drawable.release();
+  return entry->drawable;
+}
+
+Drawable *SharedImageCache::createSvgDrawable(const File &file) {
+  const ScopedLock sl(svgLock);
+  auto drawable = getSvgDrawable(file);
+  return drawable ? drawable->createCopy() : nullptr;
+}
+
+Image SharedImageCache::rasterizeSvg(const File &file, int width, int height, bool fit) {
+  const ScopedLock sl(svgLock);
+  auto drawable = getSvgDrawable(file);
+  if (!drawable) return Image();
+
+  Rectangle<int> size(width > 0 ? width : 128, height > 0 ? height : 128);
+  const auto bounds = drawable->getDrawableBounds();
+  if (fit && !bounds.isEmpty()) {
+    // fractional SVG sizes, keep some precision for the aspect ratio
+    size = fitImageSize(roundToInt(bounds.getWidth() * 64), roundToInt(bounds.getHeight() * 64),
+                        size.getWidth(), size.getHeight());
+  }
+
+  Image image(Image::ARGB, size.getWidth(), size.getHeight(), true);
+  Graphics g(image);
+  drawable->drawWithin(g, image.getBounds().toFloat(), RectanglePlacement::centred, 1.0f);
+  return image;
+}
+
+Image SharedImageCache::decode(const File &file, int width, int height, bool fit) {
+  auto &diskCache = DiskImageCache::getInstance();
+  auto image = diskCache.load(file, width, height, fit);
+  if (image.isValid()) return image;
+
+  if (file.getFileExtension() == ".svg") {
+    image = rasterizeSvg(file, width, height, fit);
+  } else {
+    image = ImageFileFormat::loadFrom(file);
+    if (image.isValid() && width > 0 && height > 0) {
+      auto size = fit ? fitImageSize(image.getWidth(), image.getHeight(), width, height)
+                      : Rectangle<int>(width, height);
+      image = downsampleImage(image, size.getWidth(), size.getHeight());
+    }
+  }
+  diskCache.store(file, width, height, fit, image);
+  return image;
+}
+
+Image SharedImageCache::getImage(const File &file, int width, int height) {
+  return getOrDecode(file, width, height, false);
+}
+
+Image SharedImageCache::getImageToFit(const File &file, int maxWidth, int maxHeight) {
+  return getOrDecode(file, maxWidth, maxHeight, true);
+}
+
+Image SharedImageCache::getOrDecode(const File &file, int width, int height, bool fit) {
+  const auto key = makeKey(file, width, height, fit);
+  {
+    const ScopedLock sl(lock);
+    if (entriesByKey.contains(key)) {
+      stats.hits++;
+      return entriesByKey[key]->image;
+    }
+    stats.misses++;
+  }
+
+  // decode outside the lock, a racing decode of the same file just loses the insert below
+  auto image = decode(file, width, height, fit);
+  if (!image.isValid()) return image;
+
+  const ScopedLock sl(lock);
+  if (entriesByKey.contains(key)) return entriesByKey[key]->image;
+  auto entry = new Entry{ key, image };
+  entries.add(entry);
+  entriesByKey.set(key, entry);
+  stats.bytes += getImageBytes(image);
+  stats.entries = entries.size();
+  return image;
+}
+
+void SharedImageCache::releaseUnused() {
+  const ScopedLock sl(lock);
+  for (int i = entries.size(); --i >= 0;) {
+    auto entry = entries.getUnchecked(i);
+    // only the cache's own reference is left
+    if (entry->image.getReferenceCount() <= 1) {
+      stats.bytes -= getImageBytes(entry->image);
+      entriesByKey.remove(entry->key);
+      entries.remove(i);
+    }
+  }
+  stats.entries = entries.size();
+}
+
+void SharedImageCache::releaseUnusedSoon() {
+  triggerAsyncUpdate();
+}
+
+void SharedImageCache::handleAsyncUpdate() {
+  releaseUnused();
+}
+
+void SharedImageCache::clear() {
+  {
+    const ScopedLock sl(lock);
+    entriesByKey.clear();
+    entries.clear();
+    stats.bytes = 0;
+    stats.entries = 0;
+  }
+  const ScopedLock sl(svgLock);
+  svgEntriesByPath.clear();
+  svgEntries.clear();
+}
+
+ImageCacheStats SharedImageCache::getStats() const {
+  const ScopedLock sl(lock);
+  return stats;
+}
+
+void SharedImageCache::logStats() const {
+  const auto s = getStats();
+  DBG("SharedImageCache: " << s.entries << " images, " << (s.bytes / 1024) << " KiB, "
+      << s.hits << " hits, " << s.misses << " misses");
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+struct ImageCacheStats {
+  int64 hits = 0;
+  int64 misses = 0;
+  int64 bytes = 0; // decoded pixel bytes currently held by the cache
+  int entries = 0;
+};
+
+// Process-wide cache of decoded images, keyed by resolved path and target size.
+// Image pixel data is already reference counted by JUCE, so the cache just keeps one
+// extra reference per entry and every page asking for the same file shares the pixels.
+// Entries that nobody but the cache still references are dropped by releaseUnused(); owners
+// letting go of images (a resized background, replaced or deleted icons) call
+// releaseUnusedSoon(), so only what's on screen or held by a page stays resident.
+// SVGs are parsed once into a Drawable and rasterized separately for each requested size;
+// like bitmaps, the rasters also end up in the DiskImageCache.
+class SharedImageCache : private AsyncUpdater {
+public:
+  static SharedImageCache &getInstance();
+
+  // A width/height of 0 means "at the file's own size" (128x128 for SVGs).
+  Image getImage(const File &file, int width = 0, int height = 0);
+  // Decodes to the largest size keeping the file's aspect ratio that fits the box. Only the
+  // scaled pixels are kept, however large the file itself is.
+  Image getImageToFit(const File &file, int maxWidth, int maxHeight);
+
+  // Returns a new copy of the file's parsed SVG, or nullptr if it can't be parsed.
+  Drawable *createSvgDrawable(const File &file);
+
+  void releaseUnused();
+  // releaseUnused() from the message loop, after whatever is being torn down right now has
+  // dropped its references too. Any thread; calls in the meantime are coalesced.
+  void releaseUnusedSoon();
+  void clear();
+
+  ImageCacheStats getStats() const;
+  void logStats() const;
+
+private:
+  SharedImageCache();
+  void handleAsyncUpdate() override;
+
+  struct Entry {
+    String key;
+    Image image;
+  };
+
+  struct SvgEntry {
+    Time modified;
+    ScopedPointer<Drawable> drawable;
+  };
+
+  static String makeKey(const File &file, int width, int height, bool fit);
+  Image decode(const File &file, int width, int height, bool fit);
+  Image getOrDecode(const File &file, int width, int height, bool fit);
+  Image rasterizeSvg(const File &file, int width, int height, bool fit);
+  const Drawable *getSvgDrawable(const File &file);
+  static int64 getImageBytes(const Image &image);
+
+  CriticalSection lock;
+  OwnedArray<Entry> entries;
+  HashMap<String, Entry *> entriesByKey;
+  ImageCacheStats stats;
+
+  // parsing and drawing share one lock, a Drawable isn't meant to be painted concurrently
+  CriticalSection svgLock;
+  OwnedArray<SvgEntry> svgEntries;
+  HashMap<String, SvgEntry *> svgEntriesByPath;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedImageCache)
+};
@@ -0,0 +1,88 @@
+#include "SpinnerComponent.h"
+#include "Utils.h"
+
+SpinnerAnimator &SpinnerAnimator::getInstance() {
+  static SpinnerAnimator instance;
+  return instance;
+}
+
+SpinnerAnimator::SpinnerAnimator() {}
+
+const Array<Image> &SpinnerAnimator::getFrames(const String &prefix) {
+  for (auto set : frameSets) {
+    if (set->prefix == prefix) return set->frames;
+  }
+
+  // decoded straight from the files, the separate frames aren't worth keeping in the
+  // shared image cache once they're packed
+  Array<Image> images;
+  int sheetWidth = 0, sheetHeight = 0;
+  for (int i = 0; i < 8; ++i) {
+    auto image = ImageFileFormat::loadFrom(assetFile(prefix + String(i) + ".png"));
+    if (!image.isValid()) break;
+    images.add(image);
+    sheetWidth += image.getWidth();
+    sheetHeight = jmax(sheetHeight, image.getHeight());
+  }
+
+  auto set = new FrameSet();
+  set->prefix = prefix;
+  frameSets.add(set);
+  if (images.isEmpty()) return set->frames;
+
+  set->sheet = Image(Image::ARGB, sheetWidth, sheetHeight, true);
+  Graphics g(set->sheet);
+  int x = 0;
+  for (const auto &image : images) {
+    g.drawImageAt(image, x, 0);
+    set->frames.add(set->sheet.getClippedImage(image.getBounds().withX(x)));
+    x += image.getWidth();
+  }
+  return set->frames;
+}
+
+void SpinnerAnimator::addSpinner(SpinnerComponent *spinner) {
+  spinners.addIfNotAlreadyThere(spinner);
+  if (!isTimerRunning()) startTimer(tickMillis);
+}
+
+void SpinnerAnimator::removeSpinner(SpinnerComponent *spinner) {
+  spinners.removeFirstMatchingValue(spinner);
+  if (spinners.isEmpty()) stopTimer();
+}
+
+void SpinnerAnimator::timerCallback() {
+  for (auto spinner : spinners) {
+    spinner->tick();
+  }
+}
+
+SpinnerComponent::SpinnerComponent(const String &componentName, const String &framePrefix,
+                                   int ticksPerFrame)
+: ImageComponent(componentName),
+  frames(SpinnerAnimator::getInstance().getFrames(framePrefix)),
+  ticksPerFrame(jmax(1, ticksPerFrame)) {
+  setImage(frames[0]);
+}
+
+SpinnerComponent::~SpinnerComponent() {
+  SpinnerAnimator::getInstance().removeSpinner(this);
+}
+
+void SpinnerComponent::visibilityChanged() {
+  if (isVisible()) {
+    SpinnerAnimator::getInstance().addSpinner(this);
+  } else {
+    SpinnerAnimator::getInstance().removeSpinner(this);
+  }
+}
+
+void SpinnerComponent::tick() {
+  // nobody would see the frames change
+  if (!isShowing()) return;
+
+  if (++ticks < ticksPerFrame || frames.isEmpty()) return;
+  ticks = 0;
+  frame = (frame + 1) % frames.size();
+  setImage(frames[frame]);
+}
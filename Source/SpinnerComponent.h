@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+class SpinnerComponent;
+
+// Drives every visible spinner from one timer. Frame sets are loaded once, packed into a
+// single sprite sheet, and handed out as clipped images sharing the sheet's pixels.
+// The timer only runs while at least one spinner is visible.
+class SpinnerAnimator : private Timer {
+public:
+  static SpinnerAnimator &getInstance();
+
+  // Frames <prefix>0.png ... <prefix>7.png from the assets.
+  const Array<Image> &getFrames(const String &prefix);
+
+  void addSpinner(SpinnerComponent *spinner);
+  void removeSpinner(SpinnerComponent *spinner);
+
+  static const int tickMillis = 500;
+
+private:
+  SpinnerAnimator();
+
+  void timerCallback() override;
+
+  struct FrameSet {
+    String prefix;
+    Image sheet;
+    Array<Image> frames;
+  };
+
+  OwnedArray<FrameSet> frameSets;
+  Array<SpinnerComponent *> spinners;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpinnerAnimator)
+};
+
+// An ImageComponent cycling through a frame set while it's visible.
+class SpinnerComponent : public ImageComponent {
+public:
+  SpinnerComponent(const String &componentName, const String &framePrefix,
+                   int ticksPerFrame = 1);
+  ~SpinnerComponent();
+
+  void visibilityChanged() override;
+
+private:
+  friend class SpinnerAnimator;
+  void tick();
+
+  const Array<Image> &frames;
+  const int ticksPerFrame;
+  int ticks = 0;
+  int frame = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpinnerComponent)
+};
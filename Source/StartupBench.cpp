@@ -0,0 +1,82 @@
+#include "StartupBench.h"
+#include "AsyncInit.h"
+
+#include <time.h>
+
+// how long the UI sits idle after becoming interactive before the steady RSS is taken
+#define STEADY_STATE_DELAY 1000 // milliseconds
+
+namespace {
+
+double monotonicMillis() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+}
+
+// A field like "VmHWM:     41236 kB" from /proc/self/status, in kB
+int64 readProcStatusKb(const String &field) {
+  StringArray lines;
+  File("/proc/self/status").readLines(lines);
+  for (const auto &line : lines) {
+    if (line.startsWith(field + ":"))
+      return line.fromFirstOccurrenceOf(":", false, false).trim().getLargeIntValue();
+  }
+  return -1;
+}
+
+} // namespace
+
+StartupBench &StartupBench::getInstance() {
+  static StartupBench instance;
+  return instance;
+}
+
+StartupBench::StartupBench() {}
+
+void StartupBench::enable() {
+  const auto t0 = SystemStats::getEnvironmentVariable("POCKET_HOME_BENCH_T0", String());
+  origin = t0.isNotEmpty() ? t0.getLargeIntValue() / 1.0e6 : monotonicMillis();
+  enabled = true;
+}
+
+bool StartupBench::isEnabled() const {
+  return enabled;
+}
+
+double StartupBench::now() const {
+  return monotonicMillis() - origin;
+}
+
+void StartupBench::framePainted(bool live) {
+  if (!enabled) return;
+  if (firstFrame < 0) firstFrame = now();
+  if (live && liveFrame < 0) {
+    liveFrame = now();
+    startTimer(10);
+  }
+}
+
+void StartupBench::timerCallback() {
+  if (interactive < 0) {
+    if (AsyncInit::getInstance().getNumPending() > 0) return;
+    interactive = now();
+    startTimer(STEADY_STATE_DELAY);
+    return;
+  }
+  stopTimer();
+  report();
+}
+
+void StartupBench::report() {
+  DynamicObject::Ptr result = new DynamicObject();
+  result->setProperty("bench", 1);
+  result->setProperty("firstFrame", firstFrame);
+  result->setProperty("liveFrame", liveFrame);
+  result->setProperty("interactive", interactive);
+  result->setProperty("peakRssKb", readProcStatusKb("VmHWM"));
+  result->setProperty("steadyRssKb", readProcStatusKb("VmRSS"));
+  std::cout << JSON::toString(var(result), true) << std::endl;
+
+  JUCEApplication::getInstance()->systemRequestedQuit();
+}
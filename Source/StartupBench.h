@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// The exit hook behind --bench-exit, for scripts/bench-startup.py.
+// Once the UI is interactive (the live UI has painted and every AsyncInit task has reported
+// back) and has then been left alone for a moment, one JSON line goes to stdout and the
+// app quits:
+//
+//   {"bench":1,"firstFrame":312.4,"liveFrame":845.0,"interactive":861.2,
+//    "peakRssKb":41236,"steadyRssKb":38112}
+//
+// Times are ms since POCKET_HOME_BENCH_T0 (the runner's CLOCK_MONOTONIC in ns when it
+// spawned us), or since enable() when that isn't set.
+class StartupBench : private Timer {
+public:
+  static StartupBench &getInstance();
+
+  void enable();
+  bool isEnabled() const;
+
+  // live is false for the boot snapshot, true once MainContentComponent paints
+  void framePainted(bool live);
+
+private:
+  StartupBench();
+
+  double now() const;
+  void timerCallback() override;
+  void report();
+
+  bool enabled = false;
+  double origin = 0;
+  double firstFrame = -1, liveFrame = -1, interactive = -1;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StartupBench)
+};
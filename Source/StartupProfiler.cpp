@@ -0,0 +1,109 @@
+#include "StartupProfiler.h"
+
+StartupProfiler &StartupProfiler::getInstance() {
+  static StartupProfiler instance;
+  return instance;
+}
+
+StartupProfiler::StartupProfiler() {}
+
+double StartupProfiler::now() const {
+  // CLOCK_MONOTONIC on Linux, unaffected by the clock being set during boot
+  return Time::getMillisecondCounterHiRes() - origin;
+}
+
+void StartupProfiler::enable(const File &file) {
+  logFile = file;
+  origin = Time::getMillisecondCounterHiRes();
+  records.clear();
+  // the root phase, from here to the first frame
+  records.add({ "startup", -1, 0, -1 });
+  current = 0;
+  enabled = true;
+}
+
+bool StartupProfiler::isEnabled() const {
+  return enabled;
+}
+
+int StartupProfiler::beginPhase(const char *name) {
+  if (!enabled) return -1;
+  auto messageManager = MessageManager::getInstanceWithoutCreating();
+  if (!messageManager || !messageManager->isThisTheMessageThread()) return -1;
+  records.add({ name, current, now(), -1 });
+  current = records.size() - 1;
+  return current;
+}
+
+void StartupProfiler::endPhase(int index) {
+  if (!enabled || index < 0) return;
+  auto &record = records.getReference(index);
+  record.end = now();
+  current = record.parent;
+}
+
+void StartupProfiler::framePainted() {
+  if (enabled) finish();
+}
+
+void StartupProfiler::finish() {
+  enabled = false;
+  const double end = now();
+  // anything still open (the message loop itself) ends with the first frame
+  for (auto &record : records) {
+    if (record.end < 0) record.end = end;
+  }
+
+  std::cerr << "startup profile (ms):" << std::endl;
+  printTree(-1, 0);
+  if (logFile != File()) appendLogLine();
+  records.clear();
+}
+
+void StartupProfiler::printTree(int parent, int depth) const {
+  for (int i = 0; i < records.size(); ++i) {
+    const auto &record = records.getReference(i);
+    if (record.parent != parent) continue;
+    std::cerr << String(record.end - record.start, 1).paddedLeft(' ', 9) << "  "
+              << String::repeatedString("  ", depth) << record.name << std::endl;
+    printTree(i, depth + 1);
+  }
+}
+
+String StartupProfiler::getPath(int index) const {
+  const auto &record = records.getReference(index);
+  return record.parent < 0 ? record.name : getPath(record.parent) + "/" + record.name;
+}
+
+void StartupProfiler::appendLogLine() const {
+  Array<var> phases;
+  for (int i = 0; i < records.size(); ++i) {
+    const auto &record = records.getReference(i);
+    DynamicObject::Ptr phase = new DynamicObject();
+    phase->setProperty("path", getPath(i));
+    phase->setProperty("start", record.start);
+    phase->setProperty("ms", record.end - record.start);
+    phases.add(phase.get());
+  }
+
+  DynamicObject::Ptr line = new DynamicObject();
+  line->setProperty("time", Time::currentTimeMillis());
+  line->setProperty("version", ProjectInfo::versionString);
+  line->setProperty("total", records.getReference(0).end);
+  line->setProperty("phases", phases);
+
+  FileOutputStream out(logFile);
+  if (out.failedToOpen()) {
+    std::cerr << "Can't write startup profile to " << logFile.getFullPathName() << std::endl;
+    return;
+  }
+  // FileOutputStream appends to an existing file
+  out << JSON::toString(var(line.get()), true) << "\n";
+}
+
+StartupPhase::StartupPhase(const char *name)
+: index(StartupProfiler::getInstance().beginPhase(name)) {}
+
+StartupPhase::~StartupPhase() {
+  StartupProfiler::getInstance().endPhase(index);
+}
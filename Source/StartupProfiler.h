@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Records how long each startup phase takes, enabled with --profile-startup.
+// Phases are scoped and nest, so the report is a tree of durations from launch to the
+// first frame on screen:
+//
+//   StartupPhase phase("sound");
+//
+// Timestamps come from the monotonic clock. Phases are only recorded on the message
+// thread; anything else (and every phase once profiling is off) costs one flag check.
+class StartupProfiler {
+public:
+  static StartupProfiler &getInstance();
+
+  // Starts the clock. With a log file, finish() also appends one JSON line per boot to it.
+  void enable(const File &logFile = File());
+  bool isEnabled() const;
+
+  // Called for every paint; the first one ends the profile, prints the tree to stderr and
+  // writes the log line.
+  void framePainted();
+
+  int beginPhase(const char *name);
+  void endPhase(int index);
+
+private:
+  StartupProfiler();
+
+  struct Record {
+    String name;
+    int parent;
+    double start, end; // ms since enable()
+  };
+
+  double now() const;
+  void finish();
+  void printTree(int parent, int depth) const;
+  String getPath(int index) const;
+  void appendLogLine() const;
+
+  bool enabled = false;
+  File logFile;
+  double origin = 0;
+  Array<Record> records;
+  int current = -1;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StartupProfiler)
+};
+
+// Times the enclosing scope as a startup phase.
+class StartupPhase {
+public:
+  explicit StartupPhase(const char *name);
+  ~StartupPhase();
+
+private:
+  int index;
+
+  JUCE_DECLARE_NON_COPYABLE(StartupPhase)
+};
+
+// new T(args...) timed as a startup phase, for member initialiser lists.
+template <typename T, typename... Args> T *createTimed(const char *phaseName, Args &&... args) {
+  StartupPhase phase(phaseName);
+  return new T(std::forward<Args>(args)...);
+}
@@ -1,4 +1,7 @@
 #include "Utils.h"
+#include "SharedImageCache.h"
+#include "AssetResolver.h"
+#include "ImageKernels.h"
 
 File absoluteFileFromPath(const String &path) {
   return File::isAbsolutePath(path) ? File(path)
@@ -13,38 +16,35 @@ File assetConfigFile(const String &fileName) {
 }
 
 
-// TODO: allow user overrides of asset files
+// Assets are looked up in ~/.pocket-home/assets, then /usr/share/pocket-home, then the
+// development tree, see AssetResolver.
 File assetFile(const String &fileName) {
-  auto devFile = absoluteFileFromPath("../../assets/" + fileName);
-  File assetFile;
-  
-#if JUCE_LINUX
-  // are we linux? look in /usr/share/
-  // FIXME: don't hardcode this, maybe find it via .deb configuration
-  File linuxAssetFile = absoluteFileFromPath("/usr/share/pocket-home/" + fileName);
-  // look in relative path, used in development builds
-  assetFile = linuxAssetFile.exists() ? linuxAssetFile : devFile;
-  if(assetFile==devFile && !devFile.exists())
-    assetFile = absoluteFileFromPath(fileName);
-#else
-  assetFile = devFile;
-#endif
-  
-  return assetFile;
+  return AssetResolver::getInstance().resolve(fileName);
 }
 
+// Decoded images are shared through SharedImageCache, so asking for the same file twice
+// returns the same pixels instead of decoding it again.
 Image createImageFromFile(const File &imageFile) {
-  auto image = Image(Image::ARGB, 128, 128, true);
+  return SharedImageCache::getInstance().getImage(imageFile);
+}
+
+Image createImageFromFile(const File &imageFile, int width, int height) {
+  return SharedImageCache::getInstance().getImage(imageFile, width, height);
+}
+
+Image createImageToFit(const File &imageFile, int maxWidth, int maxHeight) {
+  return SharedImageCache::getInstance().getImageToFit(imageFile, maxWidth, maxHeight);
+}
+
+Drawable *createDrawableFromFile(const File &imageFile) {
   if (imageFile.getFileExtension() == ".svg") {
-    ScopedPointer<XmlElement> svgElement = XmlDocument::parse(imageFile);
-    ScopedPointer<Drawable> svgDrawable = Drawable::createFromSVG(*svgElement);
-    Graphics g(image);
-    svgDrawable->drawWithin(g, Rectangle<float>(0, 0, image.getWidth(), image.getHeight()),
-                            RectanglePlacement::centred, 1.0f);
-  } else {
-    image = ImageFileFormat::loadFrom(imageFile);
+    return SharedImageCache::getInstance().createSvgDrawable(imageFile);
   }
-  return image;
+  auto image = createImageFromFile(imageFile);
+  if (!image.isValid()) return nullptr;
+  auto drawable = new DrawableImage();
+  drawable->setImage(image);
+  return drawable;
 }
 
 ImageButton *createImageButton(const String &name, const File &imageFile) {
@@ -52,6 +52,19 @@ ImageButton *createImageButton(const String &name, const File &imageFile) {
   return createImageButton(name, image);
 }
 
+// Copy of the image with its alpha scaled, so a faded state is a plain blit rather than an
+// opacity blend every time the button is painted.
+static Image createFadedImage(const Image &image, float opacity) {
+  if (!image.isValid()) return image;
+  Image faded = image.isARGB() ? image.createCopy() : image.convertedToFormat(Image::ARGB);
+  Image::BitmapData pixels(faded, Image::BitmapData::readWrite);
+  const uint8 alpha = (uint8)jlimit(0, 255, roundToInt(opacity * 255.0f));
+  for (int y = 0; y < faded.getHeight(); ++y) {
+    ImageKernels::get().multiplyAlpha(pixels.getLinePointer(y), faded.getWidth(), alpha);
+  }
+  return faded;
+}
+
 ImageButton *createImageButton(const String &name, const Image &image) {
   auto imageButton = new ImageButton("Back");
   // FIXME: to support touch areas of different size from the base image,
@@ -61,7 +74,7 @@ ImageButton *createImageButton(const String &name, const Image &image) {
   imageButton->setImages(true, true, true,
                     image, 1.0f, Colours::transparentWhite, // normal
                     image, 1.0f, Colours::transparentWhite, // over
-                    image, 0.5f, Colours::transparentWhite, // down
+                    createFadedImage(image, 0.5f), 1.0f, Colours::transparentWhite, // down
                     0);
   return imageButton;
 }
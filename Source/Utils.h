@@ -7,6 +7,9 @@ File assetFile(const String &path);
 File assetConfigFile(const String &fileName);
 
 Image createImageFromFile(const File &imageFile);
+Image createImageFromFile(const File &imageFile, int width, int height);
+Image createImageToFit(const File &imageFile, int maxWidth, int maxHeight);
+Drawable *createDrawableFromFile(const File &imageFile);
 ImageButton *createImageButton(const String &name, const File &imageFile);
 ImageButton *createImageButton(const String &name, const Image &image);
 ImageButton *createImageButtonFromDrawable(const String &name, const Drawable &drawable);
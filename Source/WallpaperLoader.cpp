@@ -0,0 +1,340 @@
+#include "WallpaperLoader.h"
+#include "DiskImageCache.h"
+#include "ImageScaling.h"
+
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+#include <png.h>
+
+// The libjpeg/libpng readers below report errors with longjmp, so they stick to plain
+// buffers kept in a state struct owned by the caller, which also cleans up after them.
+
+namespace {
+
+struct JpegState {
+  jpeg_decompress_struct cinfo;
+  struct {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+  } err;
+  FILE *fp;
+  uint8 *pixels; // RGB, width * height * 3
+  int width, height;
+};
+
+void jpegErrorExit(j_common_ptr cinfo) {
+  auto err = reinterpret_cast<decltype(JpegState::err) *>(cinfo->err);
+  longjmp(err->jump, 1);
+}
+
+void jpegOutputMessage(j_common_ptr) {}
+
+// Decodes with the largest DCT scale-down that still covers width x height.
+bool readJpegScaled(JpegState *s, int width, int height) {
+  s->cinfo.err = jpeg_std_error(&s->err.pub);
+  s->err.pub.error_exit = jpegErrorExit;
+  s->err.pub.output_message = jpegOutputMessage;
+  if (setjmp(s->err.jump)) return false;
+
+  jpeg_create_decompress(&s->cinfo);
+  jpeg_stdio_src(&s->cinfo, s->fp);
+  jpeg_read_header(&s->cinfo, TRUE);
+
+  unsigned int denom = 8;
+  while (denom > 1 && ((s->cinfo.image_width + denom - 1) / denom < (unsigned)width ||
+                       (s->cinfo.image_height + denom - 1) / denom < (unsigned)height)) {
+    denom /= 2;
+  }
+  s->cinfo.scale_num = 1;
+  s->cinfo.scale_denom = denom;
+  s->cinfo.out_color_space = JCS_RGB;
+  jpeg_start_decompress(&s->cinfo);
+
+  s->width = s->cinfo.output_width;
+  s->height = s->cinfo.output_height;
+  s->pixels = (uint8 *)malloc((size_t)s->width * s->height * 3);
+  if (!s->pixels) return false;
+
+  while (s->cinfo.output_scanline < s->cinfo.output_height) {
+    JSAMPROW row = s->pixels + (size_t)s->cinfo.output_scanline * s->width * 3;
+    jpeg_read_scanlines(&s->cinfo, &row, 1);
+  }
+  jpeg_finish_decompress(&s->cinfo);
+  return true;
+}
+
+struct PngState {
+  png_structp png;
+  png_infop info;
+  FILE *fp;
+  uint8 *row;      // one source row, RGB
+  float *hrow;     // that row reduced to the target width
+  float *acc;      // output row being accumulated
+  int *first;      // per output column: first source column, ...
+  int *count;      // ... number of source columns, ...
+  float *weights;  // ... and their weights, maxTaps per column
+  int maxTaps;
+};
+
+void pngError(png_structp png, png_const_charp) {
+  longjmp(png_jmpbuf(png), 1);
+}
+
+void pngWarning(png_structp, png_const_charp) {}
+
+// Reads the PNG row by row, box filtering each row down to width as it arrives and
+// accumulating rows into the output row they cover. out is width * height * 3 bytes, RGB.
+bool readPngScaled(PngState *s, int width, int height, uint8 *out) {
+  s->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, pngError, pngWarning);
+  if (!s->png) return false;
+  s->info = png_create_info_struct(s->png);
+  if (!s->info) return false;
+  if (setjmp(png_jmpbuf(s->png))) return false;
+
+  png_init_io(s->png, s->fp);
+  png_read_info(s->png, s->info);
+
+  const int srcWidth = png_get_image_width(s->png, s->info);
+  const int srcHeight = png_get_image_height(s->png, s->info);
+  const int colorType = png_get_color_type(s->png, s->info);
+  const int bitDepth = png_get_bit_depth(s->png, s->info);
+  // interlaced or upscaled images are left to the fallback decoder
+  if (png_get_interlace_type(s->png, s->info) != PNG_INTERLACE_NONE || srcWidth < width ||
+      srcHeight < height) {
+    return false;
+  }
+
+  // everything to 8 bit RGB, alpha is dropped since the wallpaper is drawn opaque
+  if (colorType == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(s->png);
+  if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8) png_set_expand_gray_1_2_4_to_8(s->png);
+  if (png_get_valid(s->png, s->info, PNG_INFO_tRNS)) png_set_tRNS_to_alpha(s->png);
+  if (bitDepth == 16) png_set_strip_16(s->png);
+  if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA) {
+    png_set_gray_to_rgb(s->png);
+  }
+  png_set_strip_alpha(s->png);
+  png_read_update_info(s->png, s->info);
+  if (png_get_rowbytes(s->png, s->info) != (size_t)srcWidth * 3) return false;
+
+  const double xScale = double(srcWidth) / width;
+  const double yScale = double(srcHeight) / height;
+  s->maxTaps = (int)std::ceil(xScale) + 1;
+  s->row = (uint8 *)malloc((size_t)srcWidth * 3);
+  s->hrow = (float *)malloc(sizeof(float) * width * 3);
+  s->acc = (float *)calloc((size_t)width * 3, sizeof(float));
+  s->first = (int *)malloc(sizeof(int) * width);
+  s->count = (int *)malloc(sizeof(int) * width);
+  s->weights = (float *)malloc(sizeof(float) * width * s->maxTaps);
+  if (!s->row || !s->hrow || !s->acc || !s->first || !s->count || !s->weights) return false;
+
+  for (int x = 0; x < width; ++x) {
+    const double start = x * xScale;
+    const double end = jmin(double(srcWidth), (x + 1) * xScale);
+    s->first[x] = (int)start;
+    s->count[x] = 0;
+    for (int sx = (int)start; sx < srcWidth && sx < end && s->count[x] < s->maxTaps; ++sx) {
+      const double covered = jmin(end, sx + 1.0) - jmax(start, double(sx));
+      s->weights[x * s->maxTaps + s->count[x]++] = float(covered / xScale);
+    }
+  }
+
+  int outRow = 0;
+  for (int y = 0; y < srcHeight; ++y) {
+    png_read_row(s->png, s->row, nullptr);
+
+    for (int x = 0; x < width; ++x) {
+      float r = 0, g = 0, b = 0;
+      const uint8 *p = s->row + s->first[x] * 3;
+      const float *w = s->weights + x * s->maxTaps;
+      for (int i = 0; i < s->count[x]; ++i, p += 3) {
+        r += w[i] * p[0];
+        g += w[i] * p[1];
+        b += w[i] * p[2];
+      }
+      s->hrow[x * 3] = r;
+      s->hrow[x * 3 + 1] = g;
+      s->hrow[x * 3 + 2] = b;
+    }
+
+    // a source row covers the end of one output row and possibly the start of the next
+    while (outRow < height) {
+      const double rowStart = outRow * yScale;
+      const double rowEnd = jmin(double(srcHeight), (outRow + 1) * yScale);
+      const double covered = jmin(y + 1.0, rowEnd) - jmax(double(y), rowStart);
+      if (covered > 0) {
+        const float w = float(covered / yScale);
+        for (int i = 0; i < width * 3; ++i) s->acc[i] += w * s->hrow[i];
+      }
+      if (rowEnd > y + 1.0) break;
+
+      uint8 *dest = out + (size_t)outRow * width * 3;
+      for (int i = 0; i < width * 3; ++i) {
+        dest[i] = (uint8)jlimit(0, 255, int(s->acc[i] + 0.5f));
+        s->acc[i] = 0;
+      }
+      ++outRow;
+    }
+  }
+
+  png_read_end(s->png, nullptr);
+  return outRow == height;
+}
+
+Image imageFromRGB(const uint8 *rgb, int width, int height) {
+  Image image(Image::RGB, width, height, false);
+  Image::BitmapData data(image, Image::BitmapData::writeOnly);
+  for (int y = 0; y < height; ++y) {
+    auto dest = reinterpret_cast<PixelRGB *>(data.getLinePointer(y));
+    const uint8 *src = rgb + (size_t)y * width * 3;
+    for (int x = 0; x < width; ++x, src += 3) {
+      dest[x].setARGB(255, src[0], src[1], src[2]);
+    }
+  }
+  return image;
+}
+
+Image decodeJpeg(const File &file, int width, int height) {
+  JpegState s;
+  zerostruct(s);
+  s.fp = fopen(file.getFullPathName().toRawUTF8(), "rb");
+  if (!s.fp) return Image();
+
+  Image image;
+  if (readJpegScaled(&s, width, height)) {
+    image = downsampleImage(imageFromRGB(s.pixels, s.width, s.height), width, height);
+  }
+  jpeg_destroy_decompress(&s.cinfo);
+  free(s.pixels);
+  fclose(s.fp);
+  return image;
+}
+
+Image decodePng(const File &file, int width, int height) {
+  PngState s;
+  zerostruct(s);
+  s.fp = fopen(file.getFullPathName().toRawUTF8(), "rb");
+  if (!s.fp) return Image();
+
+  HeapBlock<uint8> out((size_t)width * height * 3);
+  Image image;
+  if (readPngScaled(&s, width, height, out)) {
+    image = imageFromRGB(out, width, height);
+  }
+  png_destroy_read_struct(s.png ? &s.png : nullptr, s.info ? &s.info : nullptr, nullptr);
+  free(s.row);
+  free(s.hrow);
+  free(s.acc);
+  free(s.first);
+  free(s.count);
+  free(s.weights);
+  fclose(s.fp);
+  return image;
+}
+
+} // namespace
+
+Image decodeWallpaper(const File &file, int width, int height) {
+  if (width <= 0 || height <= 0) return Image();
+
+  auto &diskCache = DiskImageCache::getInstance();
+  auto image = diskCache.load(file, width, height);
+  if (image.isValid()) return image;
+
+  const auto extension = file.getFileExtension().toLowerCase();
+  if (extension == ".jpg" || extension == ".jpeg") {
+    image = decodeJpeg(file, width, height);
+  } else if (extension == ".png") {
+    image = decodePng(file, width, height);
+  }
+
+  // other formats, interlaced or small PNGs, or a file whose extension lied
+  if (!image.isValid()) {
+    image = ImageFileFormat::loadFrom(file);
+    if (!image.isValid()) return image;
+    image = downsampleImage(image, width, height).convertedToFormat(Image::RGB);
+  }
+
+  diskCache.store(file, width, height, false, image);
+  return image;
+}
+
+class WallpaperLoader::DeliveryMessage : public CallbackMessage {
+public:
+  DeliveryMessage(WallpaperLoader &loader, int generation, const File &file, const Image &image)
+  : loader(loader), alive(loader.alive), generation(generation), file(file), image(image) {}
+
+  void messageCallback() override {
+    if (alive->alive) loader.deliver(generation, file, image);
+  }
+
+private:
+  WallpaperLoader &loader;
+  ReferenceCountedObjectPtr<Alive> alive;
+  int generation;
+  File file;
+  Image image;
+};
+
+WallpaperLoader::WallpaperLoader(Listener *listener)
+: Thread("WallpaperLoader"), listener(listener), alive(new Alive()) {}
+
+WallpaperLoader::~WallpaperLoader() {
+  alive->alive = false;
+  stopThread(5000);
+}
+
+void WallpaperLoader::load(const File &newFile, int newWidth, int newHeight) {
+  {
+    const ScopedLock sl(lock);
+    // already loading or loaded, use cancel() first to force a reload
+    if (newFile == file && newWidth == width && newHeight == height) return;
+    file = newFile;
+    width = newWidth;
+    height = newHeight;
+    ++generation;
+  }
+  if (isThreadRunning()) {
+    notify();
+  } else {
+    startThread(3);
+  }
+}
+
+void WallpaperLoader::cancel() {
+  const ScopedLock sl(lock);
+  ++generation;
+  file = File::nonexistent;
+}
+
+void WallpaperLoader::run() {
+  int done = -1;
+  while (!threadShouldExit()) {
+    File toLoad;
+    int w, h, requested;
+    {
+      const ScopedLock sl(lock);
+      toLoad = file;
+      w = width;
+      h = height;
+      requested = generation;
+    }
+
+    if (requested == done || toLoad == File::nonexistent) {
+      wait(-1);
+      continue;
+    }
+
+    auto image = decodeWallpaper(toLoad, w, h);
+    done = requested;
+    (new DeliveryMessage(*this, requested, toLoad, image))->post();
+  }
+}
+
+void WallpaperLoader::deliver(int delivered, const File &loadedFile, const Image &image) {
+  {
+    const ScopedLock sl(lock);
+    if (delivered != generation) return;
+  }
+  listener->wallpaperLoaded(loadedFile, image);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Decodes a wallpaper straight to the size it's shown at, as an opaque RGB image.
+// JPEGs are scaled by libjpeg while decoding (DCT scaling to the nearest 1/2, 1/4 or 1/8
+// at or above the target size), non-interlaced PNGs are box filtered one row at a time as
+// libpng hands them over, so neither ever holds the full resolution picture in memory.
+// Anything else goes through JUCE's decoder and ImageScaling.
+Image decodeWallpaper(const File &file, int width, int height);
+
+// Runs decodeWallpaper() on its own thread and hands the result back on the message thread.
+// Only the most recent request is delivered.
+class WallpaperLoader : private Thread {
+public:
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    virtual void wallpaperLoaded(const File &file, const Image &image) = 0;
+  };
+
+  WallpaperLoader(Listener *listener);
+  ~WallpaperLoader();
+
+  void load(const File &file, int width, int height);
+  void cancel();
+
+private:
+  class DeliveryMessage;
+
+  void run() override;
+  void deliver(int generation, const File &file, const Image &image);
+
+  Listener *listener;
+
+  CriticalSection lock;
+  File file;
+  int width = 0, height = 0;
+  int generation = 0;
+
+  // shared with pending DeliveryMessages, so they can tell the loader is gone
+  struct Alive : public ReferenceCountedObject {
+    bool alive = true;
+  };
+  ReferenceCountedObjectPtr<Alive> alive;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WallpaperLoader)
+};
@@ -6,5 +6,13 @@
 WifiStatus::WifiStatus() {}
 WifiStatus::~WifiStatus() {}
 
+void WifiStatus::initializeStatusAsync() {
+  initializeStatus();
+}
+
+bool WifiStatus::isInitialized() const {
+  return true;
+}
+
 WifiStatus::Listener::Listener() {}
 WifiStatus::Listener::~Listener() {}
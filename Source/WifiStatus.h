@@ -30,6 +30,11 @@ public:
   virtual void setDisconnected() = 0;
 
   virtual void initializeStatus() = 0;
+  // Like initializeStatus(), but anything slow happens on a worker thread. Until it's done
+  // the status is unknown (isInitialized() is false); listeners then get handleWifiEnabled()
+  // or handleWifiDisabled() on the message thread.
+  virtual void initializeStatusAsync();
+  virtual bool isInitialized() const;
 };
 
 class WifiStatus::Listener {
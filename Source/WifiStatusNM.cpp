@@ -5,6 +5,7 @@
 #include <nm-utils.h>
 
 #include "WifiStatus.h"
+#include "AsyncInit.h"
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #define LIBNM_ITERATION_PERIOD 100 // milliseconds
@@ -512,6 +513,38 @@ void WifiStatusNM::initializeStatus() {
   if (!this->connectToNetworkManager())
     DBG("WifiStatusNM: failed to connect to nmclient over dbus");
 
+  finishInitialize();
+}
+
+void WifiStatusNM::initializeStatusAsync() {
+  connectedAP = nullptr;
+  connected = false;
+  enabled = false;
+  initialized = false;
+
+  // nm_client_new() makes several blocking D-Bus round trips
+  AsyncInit::getInstance().run<bool>("wifi status",
+    [this] { return this->connectToNetworkManager() != nullptr; },
+    [this](const bool &ok) {
+      if (!ok)
+        DBG("WifiStatusNM: failed to connect to nmclient over dbus");
+      finishInitialize();
+
+      for (const auto& listener : listeners)
+        enabled ? listener->handleWifiEnabled() : listener->handleWifiDisabled();
+      if (connected)
+        for (const auto& listener : listeners)
+          listener->handleWifiConnected();
+    });
+}
+
+bool WifiStatusNM::isInitialized() const {
+  return initialized;
+}
+
+void WifiStatusNM::finishInitialize() {
+  initialized = true;
+
   nmlistener = new NMListener();
   nmlistener->initialize(this, nmclient);
   nmlistener->startThread();
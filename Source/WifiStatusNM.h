@@ -31,6 +31,8 @@ public:
   void setDisconnected() override;
 
   void initializeStatus() override;
+  void initializeStatusAsync() override;
+  bool isInitialized() const override;
 
   void handleWirelessEnabled();
   void handleWirelessConnected();
@@ -42,8 +44,11 @@ private:
   bool enabled = false;
   bool connected = false;
   bool connecting = false;
+  bool initialized = false;
 
   NMClient* connectToNetworkManager();
+  // the part of initialization after connecting, must run on the message thread
+  void finishInitialize();
 
   NMClient *nmclient = nullptr;
   NMDevice *nmdevice = nullptr;
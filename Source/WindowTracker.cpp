@@ -0,0 +1,262 @@
+#include "WindowTracker.h"
+
+#include <poll.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+
+// Windows can disappear between reading the client list and asking about them. The
+// BadWindow errors that causes go to the error handler JUCE installs for the process,
+// which only logs them.
+
+namespace {
+
+::Display *toDisplay(void *display) {
+  return static_cast<::Display *>(display);
+}
+
+}
+
+class WindowTracker::ListedMessage : public CallbackMessage {
+public:
+  ListedMessage(const WindowInfo &info) : info(info) {}
+
+  void messageCallback() override {
+    WindowTracker::getInstance().listeners.call(&Listener::windowListed, info);
+  }
+
+private:
+  WindowInfo info;
+};
+
+WindowTracker &WindowTracker::getInstance() {
+  static WindowTracker instance;
+  return instance;
+}
+
+WindowTracker::WindowTracker() : Thread("WindowTracker") {}
+
+WindowTracker::~WindowTracker() {
+  stop();
+}
+
+bool WindowTracker::start() {
+  if (isThreadRunning()) return true;
+  auto dpy = XOpenDisplay(nullptr);
+  if (!dpy) {
+    DBG("WindowTracker: can't open the X display, running apps won't be found");
+    return false;
+  }
+
+  {
+    const ScopedLock sl(lock);
+    display = dpy;
+    root = DefaultRootWindow(dpy);
+    netClientList = XInternAtom(dpy, "_NET_CLIENT_LIST", False);
+    netWmPid = XInternAtom(dpy, "_NET_WM_PID", False);
+    netActiveWindow = XInternAtom(dpy, "_NET_ACTIVE_WINDOW", False);
+    netWmState = XInternAtom(dpy, "_NET_WM_STATE", False);
+    netWmStateHidden = XInternAtom(dpy, "_NET_WM_STATE_HIDDEN", False);
+    XSelectInput(dpy, root, PropertyChangeMask);
+    refreshClientList(false);
+    XFlush(dpy);
+  }
+  startThread(2);
+  return true;
+}
+
+void WindowTracker::stop() {
+  stopThread(1000);
+  const ScopedLock sl(lock);
+  if (display) {
+    XCloseDisplay(toDisplay(display));
+    display = nullptr;
+  }
+  windowsByClass.clear();
+  windowsByPid.clear();
+  windowsById.clear();
+  windows.clear();
+}
+
+WindowTracker::WindowId WindowTracker::findWindowByClass(const String &wmClass) const {
+  const ScopedLock sl(lock);
+  const auto key = wmClass.toLowerCase();
+  return windowsByClass.contains(key) ? windowsByClass[key]->window : 0;
+}
+
+WindowTracker::WindowId WindowTracker::findWindowByPid(int pid) const {
+  const ScopedLock sl(lock);
+  return windowsByPid.contains(pid) ? windowsByPid[pid]->window : 0;
+}
+
+bool WindowTracker::activateWindow(WindowId window) {
+  const ScopedLock sl(lock);
+  if (!display || !window) return false;
+  auto dpy = toDisplay(display);
+
+  auto sendToRoot = [&](Atom type, long l0, long l1, long l2) {
+    XEvent event;
+    zerostruct(event);
+    event.xclient.type = ClientMessage;
+    event.xclient.window = window;
+    event.xclient.message_type = type;
+    event.xclient.format = 32;
+    event.xclient.data.l[0] = l0;
+    event.xclient.data.l[1] = l1;
+    event.xclient.data.l[2] = l2;
+    XSendEvent(dpy, root, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+  };
+
+  // _NET_WM_STATE_REMOVE the hidden state, harmless if it isn't minimized
+  sendToRoot(netWmState, 0, (long)netWmStateHidden, 0);
+  // source 2, a pager or taskbar: the user asked for it, focus stealing rules don't apply
+  sendToRoot(netActiveWindow, 2, CurrentTime, 0);
+  XFlush(dpy);
+  return true;
+}
+
+void WindowTracker::addListener(Listener *listener) {
+  listeners.add(listener);
+}
+
+void WindowTracker::removeListener(Listener *listener) {
+  listeners.remove(listener);
+}
+
+void WindowTracker::readWindowInfo(WindowInfo &info) {
+  auto dpy = toDisplay(display);
+
+  XClassHint hint;
+  if (XGetClassHint(dpy, info.window, &hint)) {
+    info.instanceName = String::fromUTF8(hint.res_name ? hint.res_name : "").toLowerCase();
+    info.className = String::fromUTF8(hint.res_class ? hint.res_class : "").toLowerCase();
+    if (hint.res_name) XFree(hint.res_name);
+    if (hint.res_class) XFree(hint.res_class);
+  }
+
+  Atom type;
+  int format;
+  unsigned long count, after;
+  unsigned char *data = nullptr;
+  info.pid = 0;
+  if (XGetWindowProperty(dpy, info.window, netWmPid, 0, 1, False, XA_CARDINAL, &type, &format,
+                         &count, &after, &data) == Success && data) {
+    // 32 bit properties come back as longs
+    if (format == 32 && count == 1) info.pid = (int)*reinterpret_cast<unsigned long *>(data);
+    XFree(data);
+  }
+}
+
+void WindowTracker::addToIndex(WindowInfo *info) {
+  windowsById.set((int64)info->window, info);
+  if (info->pid > 0) {
+    windowsByPid.set(info->pid, info);
+    return;
+  }
+  if (info->instanceName.isNotEmpty()) windowsByClass.set(info->instanceName, info);
+  if (info->className.isNotEmpty()) windowsByClass.set(info->className, info);
+}
+
+// Points the key at the newest remaining window with that class and no pid, if any.
+void WindowTracker::reindex(const String &key) {
+  if (key.isEmpty() || !windowsByClass.contains(key)) return;
+  windowsByClass.remove(key);
+  for (int i = windows.size(); --i >= 0;) {
+    auto info = windows.getUnchecked(i);
+    if (info->pid <= 0 && (info->instanceName == key || info->className == key)) {
+      windowsByClass.set(key, info);
+      break;
+    }
+  }
+}
+
+void WindowTracker::removeFromIndex(WindowInfo *info) {
+  windowsById.remove((int64)info->window);
+  if (info->pid > 0 && windowsByPid.contains(info->pid) && windowsByPid[info->pid] == info)
+    windowsByPid.remove(info->pid);
+  windows.removeObject(info, false);
+  if (windowsByClass[info->instanceName] == info) reindex(info->instanceName);
+  if (windowsByClass[info->className] == info) reindex(info->className);
+  delete info;
+}
+
+void WindowTracker::refreshClientList(bool announce) {
+  auto dpy = toDisplay(display);
+  Atom type;
+  int format;
+  unsigned long count = 0, after;
+  unsigned char *data = nullptr;
+  if (XGetWindowProperty(dpy, root, netClientList, 0, 1 << 16, False, XA_WINDOW, &type, &format,
+                         &count, &after, &data) != Success) {
+    return;
+  }
+  auto clients = reinterpret_cast<Window *>(data);
+
+  HashMap<int64, bool> listed;
+  for (unsigned long i = 0; i < count; ++i) {
+    listed.set((int64)clients[i], true);
+    if (windowsById.contains((int64)clients[i])) continue;
+
+    auto info = new WindowInfo();
+    info->window = clients[i];
+    // WM_CLASS and the pid are usually set before mapping, but not always
+    XSelectInput(dpy, info->window, PropertyChangeMask);
+    readWindowInfo(*info);
+    windows.add(info);
+    addToIndex(info);
+    if (announce) (new ListedMessage(*info))->post();
+  }
+  if (data) XFree(data);
+
+  for (int i = windows.size(); --i >= 0;) {
+    auto info = windows.getUnchecked(i);
+    if (!listed.contains((int64)info->window)) removeFromIndex(info);
+  }
+}
+
+void WindowTracker::run() {
+  struct pollfd pfd;
+  {
+    const ScopedLock sl(lock);
+    pfd.fd = ConnectionNumber(toDisplay(display));
+  }
+  pfd.events = POLLIN;
+
+  while (!threadShouldExit()) {
+    // round trips (ours, or activateWindow()'s) read pending events into Xlib's queue and
+    // leave the socket empty, poll() would sit on those until unrelated traffic arrives
+    bool queued;
+    {
+      const ScopedLock sl(lock);
+      queued = XEventsQueued(toDisplay(display), QueuedAlready) > 0;
+    }
+    if (!queued) {
+      pfd.revents = 0;
+      if (poll(&pfd, 1, 500) <= 0) continue;
+    }
+
+    const ScopedLock sl(lock);
+    auto dpy = toDisplay(display);
+    bool clientListChanged = false;
+    while (XEventsQueued(dpy, QueuedAlready) || XPending(dpy)) {
+      XEvent event;
+      XNextEvent(dpy, &event);
+      if (event.type != PropertyNotify) continue;
+
+      const auto &property = event.xproperty;
+      if (property.window == root) {
+        clientListChanged = clientListChanged || property.atom == netClientList;
+      } else if (property.atom == XA_WM_CLASS || property.atom == netWmPid) {
+        if (!windowsById.contains((int64)property.window)) continue;
+        auto info = windowsById[(int64)property.window];
+        removeFromIndex(info);
+        auto updated = new WindowInfo();
+        updated->window = property.window;
+        readWindowInfo(*updated);
+        windows.add(updated);
+        addToIndex(updated);
+      }
+    }
+    if (clientListChanged) refreshClientList(true);
+  }
+}
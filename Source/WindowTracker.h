@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Keeps an index of the top level windows the window manager lists in _NET_CLIENT_LIST,
+// by _NET_WM_PID, and by WM_CLASS for the ones that don't set a pid. It has its own X connection and thread, watching
+// PropertyNotify on the root window, so the index follows windows coming and going without
+// ever querying the server from the message thread: lookups are a hash table hit.
+class WindowTracker : private Thread {
+public:
+  // an X Window id, 0 for none
+  using WindowId = unsigned long;
+
+  struct WindowInfo {
+    WindowId window;
+    int pid; // 0 if the window doesn't say
+    String instanceName, className; // lower case
+  };
+
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    // A window the window manager has just started managing, i.e. one that was mapped for
+    // the first time. Called on the message thread.
+    virtual void windowListed(const WindowInfo &info) = 0;
+  };
+
+  static WindowTracker &getInstance();
+
+  // Returns false if there's no X display or the connection failed, lookups then find nothing.
+  bool start();
+  void stop();
+
+  WindowId findWindowByPid(int pid) const;
+  // Only windows without a _NET_WM_PID, the others belong to whichever process they name.
+  // Case insensitive, matches either half of WM_CLASS (instance or class name).
+  // Of several matching windows the most recently listed one is returned.
+  WindowId findWindowByClass(const String &wmClass) const;
+
+  // Asks the window manager to un-minimize the window and give it focus, with EWMH client
+  // messages (_NET_WM_STATE, _NET_ACTIVE_WINDOW). Doesn't wait for a reply, so it works the
+  // same under any compliant window manager. Returns false if there's no X connection.
+  bool activateWindow(WindowId window);
+
+  // Message thread only.
+  void addListener(Listener *listener);
+  void removeListener(Listener *listener);
+
+private:
+  WindowTracker();
+  ~WindowTracker();
+
+  class ListedMessage;
+
+  void run() override;
+  // announce is false for the windows already there when we start
+  void refreshClientList(bool announce);
+  void readWindowInfo(WindowInfo &info);
+  void addToIndex(WindowInfo *info);
+  void removeFromIndex(WindowInfo *info);
+  void reindex(const String &key);
+
+  // the display is only used with the lock held, Xlib calls on one connection mustn't overlap
+  CriticalSection lock;
+  void *display = nullptr;
+  WindowId root = 0;
+  unsigned long netClientList = 0, netWmPid = 0;
+  unsigned long netActiveWindow = 0, netWmState = 0, netWmStateHidden = 0;
+
+  OwnedArray<WindowInfo> windows;
+  HashMap<int64, WindowInfo *> windowsById;
+  // windows without a pid only
+  HashMap<String, WindowInfo *> windowsByClass;
+  HashMap<int, WindowInfo *> windowsByPid;
+
+  ListenerList<Listener> listeners;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WindowTracker)
+};
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Startup time and memory benchmark for pocket-home.
+
+Runs the binary under Xvfb with --fakewifi --bench-exit, so no NetworkManager or
+hardware is needed, and collects what the exit hook reports (see StartupBench.h):
+
+  firstFrame   ms from spawn to the first frame on screen (the boot snapshot if any)
+  liveFrame    ms from spawn to the first frame of the live UI
+  interactive  ms from spawn until the background init has all reported back
+  peakRssKb    VmHWM once interactive
+  steadyRssKb  VmRSS after sitting idle for a second
+
+Cold runs each get a fresh HOME (no config, pixel cache or boot snapshot) and have the
+binary and assets dropped from the page cache first. Warm runs share one HOME that a
+discarded priming run has filled. Results are written as JSON with percentiles.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+METRICS = ["firstFrame", "liveFrame", "interactive", "peakRssKb", "steadyRssKb"]
+
+
+def percentile(values, p):
+    values = sorted(values)
+    if not values:
+        return None
+    k = (len(values) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(values) - 1)
+    return values[lo] + (values[hi] - values[lo]) * (k - lo)
+
+
+def summarize(samples):
+    summary = {}
+    for metric in METRICS:
+        values = [s[metric] for s in samples if s.get(metric, -1) >= 0]
+        if not values:
+            continue
+        summary[metric] = {
+            "min": min(values),
+            "p50": percentile(values, 50),
+            "p90": percentile(values, 90),
+            "p99": percentile(values, 99),
+            "max": max(values),
+            "mean": sum(values) / len(values),
+        }
+    return summary
+
+
+def evict_from_page_cache(paths):
+    """Best effort: ask the kernel to drop these files' pages (no root needed)."""
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files += [os.path.join(root, name) for root, _, names in os.walk(path) for name in names]
+        else:
+            files.append(path)
+    for path in files:
+        try:
+            fd = os.open(path, os.O_RDONLY)
+        except OSError:
+            continue
+        try:
+            os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+        finally:
+            os.close(fd)
+
+
+def start_xvfb(display):
+    socket = "/tmp/.X11-unix/X%d" % display
+    xvfb = subprocess.Popen(["Xvfb", ":%d" % display, "-screen", "0", "480x272x24", "-nolisten", "tcp"],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    for _ in range(100):
+        if os.path.exists(socket):
+            return xvfb
+        if xvfb.poll() is not None:
+            break
+        time.sleep(0.05)
+    xvfb.kill()
+    sys.exit("Xvfb didn't come up on :%d" % display)
+
+
+def run_once(binary, display, home, timeout):
+    env = dict(os.environ, DISPLAY=":%d" % display, HOME=home)
+    env["POCKET_HOME_BENCH_T0"] = str(time.monotonic_ns())
+    try:
+        proc = subprocess.run([binary, "--fakewifi", "--bench-exit"], env=env, timeout=timeout,
+                              stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                              universal_newlines=True)
+    except subprocess.TimeoutExpired:
+        print("  timed out after %ds" % timeout, file=sys.stderr)
+        return None
+    for line in proc.stdout.splitlines():
+        if line.startswith("{") and '"bench"' in line:
+            return json.loads(line)
+    print("  no bench line (exit status %d)" % proc.returncode, file=sys.stderr)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--binary", default="build/Release/pocket-home")
+    parser.add_argument("--assets", default="assets", help="evicted from the page cache for cold runs")
+    parser.add_argument("--runs", type=int, default=10, help="runs per mode")
+    parser.add_argument("--modes", default="cold,warm")
+    parser.add_argument("--display", type=int, default=99)
+    parser.add_argument("--timeout", type=int, default=60, help="seconds per run")
+    parser.add_argument("--output", help="JSON results file (default: stdout)")
+    args = parser.parse_args()
+
+    binary = os.path.abspath(args.binary)
+    if not os.access(binary, os.X_OK):
+        sys.exit("no binary at %s, build it first" % binary)
+
+    xvfb = start_xvfb(args.display)
+    homes = []
+    results = {"binary": binary, "runs": args.runs, "modes": {}}
+    try:
+        for mode in args.modes.split(","):
+            warm_home = None
+            if mode == "warm":
+                warm_home = tempfile.mkdtemp(prefix="pocket-home-bench-")
+                homes.append(warm_home)
+                run_once(binary, args.display, warm_home, args.timeout)
+
+            samples = []
+            for i in range(args.runs):
+                if mode == "cold":
+                    home = tempfile.mkdtemp(prefix="pocket-home-bench-")
+                    homes.append(home)
+                    evict_from_page_cache([binary, args.assets])
+                else:
+                    home = warm_home
+                sample = run_once(binary, args.display, home, args.timeout)
+                if sample:
+                    samples.append(sample)
+                    print("%s %d/%d: %s" % (mode, i + 1, args.runs,
+                                            ", ".join("%s=%s" % (m, sample.get(m)) for m in METRICS)),
+                          file=sys.stderr)
+
+            results["modes"][mode] = {"completed": len(samples), "summary": summarize(samples),
+                                      "samples": samples}
+    finally:
+        xvfb.terminate()
+        xvfb.wait()
+        for home in homes:
+            shutil.rmtree(home, ignore_errors=True)
+
+    text = json.dumps(results, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+
+if __name__ == "__main__":
+    main()